@@ -49,6 +49,7 @@ extern "C" {
 #endif
 
 #define M_DIST_MAX 1e20f
+#define M_DIST_UMAX 0xFFFFFFFFu
 
 /* raw distance functions
       dest: squared distance */
@@ -60,13 +61,65 @@ MDAPI void m_dist_transform_2d(float *dest, float *src, int width, int height);
 MDAPI void m_voronoi_transform_1d(float *destd, int *desti, float *src, int count);
 MDAPI void m_voronoi_transform_2d(float *destd, int *desti, float *src, int width, int height);
 
+/* integer distance transform of a ubyte mask (Meijster), no float conversion
+      src: mask (inside >= 128), dest: squared distance to the closest inside pixel,
+      M_DIST_UMAX (or 65535 for ushort) if the mask is empty,
+      the ushort variant is clamped to 65535, width and height must be < 32768 */
+MDAPI void m_dist_transform_2d_mask(unsigned int *dest, const unsigned char *src, int width, int height);
+MDAPI void m_dist_transform_2d_mask_ushort(unsigned short *dest, const unsigned char *src, int width, int height);
+
+/* approximate voronoi by jump flooding (2d)
+      same input and output as m_voronoi_transform_2d,
+      log2(max(width, height)) fully parallel passes, each pixel tests 9 candidates,
+      refine: if not 0, finish with a local refinement: 1-step passes until no pixel
+         finds a closer seed among the seeds of its 8 neighbors
+         (exact in practice for seeds of equal value, seeds of different values
+         can have cells out of reach of their neighbors)
+      return: largest distance correction (in pixels) made by the refinement,
+         that is the largest error of the jump flooding passes if the refinement is exact,
+         -1 if refine is 0 (the passes alone give no error bound) */
+MDAPI float m_voronoi_transform_2d_jfa(float *destd, int *desti, float *src, int width, int height, int refine);
+
+/* incremental voronoi (2d)
+      m_voronoi_transform_2d_cache: same as m_voronoi_transform_2d,
+         but keeps its vertical pass in cached and cachei (size width * height)
+      m_voronoi_update_2d: updates destd, desti and the cache after src was modified,
+         changes: indices of the modified src pixels (added, removed, old and new position of moved seeds)
+         only the modified columns and the rows they affect are recomputed,
+         the result is identical to a full transform */
+MDAPI void m_voronoi_transform_2d_cache(float *destd, int *desti, float *cached, int *cachei, float *src, int width, int height);
+MDAPI void m_voronoi_update_2d(float *destd, int *desti, float *cached, int *cachei, float *src, int width, int height, const int *changes, int count);
+
+/* 3d (volume of width * height * depth, x major)
+      dest/destd: squared distance, desti: closest src index */
+MDAPI void m_dist_transform_3d(float *dest, float *src, int width, int height, int depth);
+MDAPI void m_voronoi_transform_3d(float *destd, int *desti, float *src, int width, int height, int depth);
+
+/* signed distance from a coverage mask (anti-aliased euclidean distance transform)
+      src: coverage in [0, 1], binary edges lie on the pixel borders,
+         anti-aliased edges are located inside their pixels from the coverage and its gradient
+      dest: signed distance in pixels to the edge (negative inside, positive outside, 0 on the edge),
+         exact up to M_SDF_BAND pixels (default 12) from the edge, within about 0.6 px further away */
+MDAPI void m_signed_dist_transform_2d(float *dest, float *src, int width, int height);
+
+/* allocation-free 1d variants
+      ws: caller workspace of at least m_dist_workspace_size(count) bytes,
+      can be reused across calls of the same or smaller count */
+MDAPI int  m_dist_workspace_size(int count);
+MDAPI void m_dist_transform_1d_ws(float *dest, float *src, int count, void *ws);
+MDAPI void m_voronoi_transform_1d_ws(float *destd, int *desti, float *src, int count, void *ws);
+
 /* image distance transform */
 #ifdef M_IMAGE_VERSION
 
 MDAPI void m_image_dist_mask_init(struct m_image *dest, const struct m_image *src); /* initialize a valid distance map from a ubyte mask */
 MDAPI void m_image_dist_transform(struct m_image *dest, const struct m_image *src);
+MDAPI void m_image_dist_transform_mask(struct m_image *dest, const struct m_image *src, char type); /* squared distance from a ubyte mask, type: M_UINT or M_USHORT (clamped) */
+MDAPI void m_image_signed_dist_transform(struct m_image *dest, const struct m_image *src); /* from a ubyte or float coverage mask */
 MDAPI void m_image_voronoi_transform(struct m_image *destd, struct m_image *desti, const struct m_image *src);
+MDAPI float m_image_voronoi_transform_jfa(struct m_image *destd, struct m_image *desti, const struct m_image *src, int refine); /* approximate, returns -1 if refine is 0 (see m_voronoi_transform_2d_jfa) */
 MDAPI void m_image_voronoi_fill(struct m_image *dest, const struct m_image *src, const struct m_image *srci);
+MDAPI void m_image_voronoi_fill_multi(struct m_image *dest, const struct m_image *src, int count, const struct m_image *srci); /* fill count images from one index map */
 
 #endif /* M_IMAGE_VERSION */
 
@@ -85,6 +138,13 @@ MDAPI void m_image_voronoi_fill(struct m_image *dest, const struct m_image *src,
 #include <math.h>
 #include <assert.h>
 
+#ifndef M_MIN
+#define M_MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef M_MAX
+#define M_MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
 /* From paper:
    Distance Transforms of Sampled Functions
    by Pedro F. Felzenszwalb and Daniel P. Huttenlocher */
@@ -108,10 +168,15 @@ for (q = 1; q < count; q++) {\
    z[k+1] = M_DIST_MAX;\
 }
 
-void m_dist_transform_1d(float *dest, float *src, int count)
+int m_dist_workspace_size(int count)
+{
+   return count * sizeof(int) + (count + 1) * sizeof(float);
+}
+
+void m_dist_transform_1d_ws(float *dest, float *src, int count, void *ws)
 {
-   int *v = (int *)malloc(count * sizeof(int));
-   float *z = (float *)malloc((count + 1) * sizeof(float));
+   int *v = (int *)ws;
+   float *z = (float *)(v + count);
    int q, k;
 
    M_DIST_T()
@@ -121,15 +186,12 @@ void m_dist_transform_1d(float *dest, float *src, int count)
       while(z[k+1] < q) k++;
       dest[q] = (q - v[k]) * (q - v[k]) + src[v[k]];
    }
-   
-   free(z);
-   free(v);
 }
 
-void m_voronoi_transform_1d(float *destd, int *desti, float *src, int count)
+void m_voronoi_transform_1d_ws(float *destd, int *desti, float *src, int count, void *ws)
 {
-   int *v = (int *)malloc(count * sizeof(int));
-   float *z = (float *)malloc((count + 1) * sizeof(float));
+   int *v = (int *)ws;
+   float *z = (float *)(v + count);
    int q, k;
 
    M_DIST_T()
@@ -140,89 +202,1137 @@ void m_voronoi_transform_1d(float *destd, int *desti, float *src, int count)
       destd[q] = (q - v[k]) * (q - v[k]) + src[v[k]];
       desti[q] = v[k];
    }
+}
+
+void m_dist_transform_1d(float *dest, float *src, int count)
+{
+   void *ws = malloc(m_dist_workspace_size(count));
+   m_dist_transform_1d_ws(dest, src, count, ws);
+   free(ws);
+}
 
-   free(z);
-   free(v);
+void m_voronoi_transform_1d(float *destd, int *desti, float *src, int count)
+{
+   void *ws = malloc(m_dist_workspace_size(count));
+   m_voronoi_transform_1d_ws(destd, desti, src, count, ws);
+   free(ws);
 }
 
+/* the 2d transforms run their columns and rows in parallel (openmp),
+   columns are processed by blocks of M_DIST_BLOCK for cache-friendly access,
+   scratch memory is allocated once per thread */
+#ifndef M_DIST_BLOCK
+#define M_DIST_BLOCK 16
+#endif
+
 void m_dist_transform_2d(float *dest, float *src, int width, int height)
 {
-	
-   float *tmp1 = (float *)malloc(M_MAX(width, height) * sizeof(float));
-   float *tmp2 = (float *)malloc(M_MAX(width, height) * sizeof(float));
-   int x, y;
+   int maxs = M_MAX(width, height);
+   int block_count = (width + M_DIST_BLOCK - 1) / M_DIST_BLOCK;
 
-   /* vertical pass */
+   #pragma omp parallel
+   {
+      float *tmp1 = (float *)malloc(M_MAX(M_DIST_BLOCK * height, width) * sizeof(float));
+      float *tmp2 = (float *)malloc(M_DIST_BLOCK * height * sizeof(float));
+      void *ws = malloc(m_dist_workspace_size(maxs));
+      int b, y;
+
+      /* vertical pass */
+      #pragma omp for schedule(dynamic, 1)
+      for (b = 0; b < block_count; b++) {
+
+         int x0 = b * M_DIST_BLOCK;
+         int bw = M_MIN(M_DIST_BLOCK, width - x0);
+         int x, i;
+
+         /* fill vertical lines */
+         for (y = 0; y < height; y++) {
+            float *row = src + width * y + x0;
+            for (i = 0; i < bw; i++)
+               tmp1[i * height + y] = row[i];
+         }
+
+         for (i = 0; i < bw; i++)
+            m_dist_transform_1d_ws(tmp2 + i * height, tmp1 + i * height, height, ws);
+
+         /* copy the result */
+         for (y = 0; y < height; y++) {
+            float *row = dest + width * y + x0;
+            for (x = 0; x < bw; x++)
+               row[x] = tmp2[x * height + y];
+         }
+      }
+
+      /* horizontal pass */
+      #pragma omp for schedule(dynamic, 8)
+      for (y = 0; y < height; y++) {
+         memcpy(tmp1, dest + width * y, width * sizeof(float));
+         m_dist_transform_1d_ws(dest + width * y, tmp1, width, ws);
+      }
+
+      free(ws);
+      free(tmp2);
+      free(tmp1);
+   }
+}
+
+/* horizontal pass of one row of the voronoi transform
+   from the vertical pass distances (srcd) and closest rows (srci) */
+static void m__voronoi_row(float *destd, int *desti, float *srcd, const int *srci, int width, int *tmpi, void *ws)
+{
+   int x;
+
+   m_voronoi_transform_1d_ws(destd, tmpi, srcd, width, ws);
+
+   /* compute 2d closest pixel index */
    for (x = 0; x < width; x++) {
+      int _x = tmpi[x];
+      int _y = srci[_x];
+      desti[x] = _y * width + _x;
+   }
+}
 
-      /* fill vertical line */
-      for (y = 0; y < height; y++)
-         tmp1[y] = *(src + width * y + x);
+/* if cached is not NULL, the vertical pass is kept in cached/cachei for m_voronoi_update_2d */
+static void m__voronoi_transform_2d(float *destd, int *desti, float *cached, int *cachei, float *src, int width, int height)
+{
+   float *vertd = cached ? cached : destd;
+   int *verti = cached ? cachei : desti;
+   int maxs = M_MAX(width, height);
+   int block_count = (width + M_DIST_BLOCK - 1) / M_DIST_BLOCK;
 
-      m_dist_transform_1d(tmp2, tmp1, height);
+   #pragma omp parallel
+   {
+      float *tmp1 = (float *)malloc(M_MAX(M_DIST_BLOCK * height, width) * sizeof(float));
+      float *tmp2 = (float *)malloc(M_DIST_BLOCK * height * sizeof(float));
+      int *tmpi1 = (int *)malloc(M_MAX(M_DIST_BLOCK * height, width) * sizeof(int));
+      int *tmpi2 = (int *)malloc(width * sizeof(int));
+      void *ws = malloc(m_dist_workspace_size(maxs));
+      int b, y;
+
+      /* vertical pass */
+      #pragma omp for schedule(dynamic, 1)
+      for (b = 0; b < block_count; b++) {
+
+         int x0 = b * M_DIST_BLOCK;
+         int bw = M_MIN(M_DIST_BLOCK, width - x0);
+         int x, i;
+
+         /* fill vertical lines */
+         for (y = 0; y < height; y++) {
+            float *row = src + width * y + x0;
+            for (i = 0; i < bw; i++)
+               tmp1[i * height + y] = row[i];
+         }
+
+         for (i = 0; i < bw; i++)
+            m_voronoi_transform_1d_ws(tmp2 + i * height, tmpi1 + i * height, tmp1 + i * height, height, ws);
+
+         /* copy the result */
+         for (y = 0; y < height; y++) {
+            float *rowd = vertd + width * y + x0;
+            int *rowi = verti + width * y + x0;
+            for (x = 0; x < bw; x++) {
+               rowd[x] = tmp2[x * height + y];
+               rowi[x] = tmpi1[x * height + y];
+            }
+         }
+      }
+
+      /* horizontal pass */
+      #pragma omp for schedule(dynamic, 8)
+      for (y = 0; y < height; y++) {
 
-      /* copy the result */
-      for (y = 0; y < height; y++)
-         *(dest + width * y + x) = tmp2[y];
+         if (cached) {
+            m__voronoi_row(destd + width * y, desti + width * y, cached + width * y, cachei + width * y, width, tmpi1, ws);
+         }
+         else {
+            /* copy distance and index of current line */
+            memcpy(tmp1, destd + width * y, width * sizeof(float));
+            memcpy(tmpi2, desti + width * y, width * sizeof(int));
+            m__voronoi_row(destd + width * y, desti + width * y, tmp1, tmpi2, width, tmpi1, ws);
+         }
+      }
+
+      free(ws);
+      free(tmpi2);
+      free(tmpi1);
+      free(tmp2);
+      free(tmp1);
    }
+}
+
+void m_voronoi_transform_2d(float *destd, int *desti, float *src, int width, int height)
+{
+   m__voronoi_transform_2d(destd, desti, NULL, NULL, src, width, height);
+}
+
+/* From paper:
+   A General Algorithm for Computing Distance Transforms in Linear Time
+   by A. Meijster, J.B.T.M. Roerdink and W.H. Hesselink */
+
+/* vertical pass on a band of columns in row order (column distance stored in dest) */
+#define M_DIST_MASK_COLUMNS(T, TMAX)\
+{\
+   int x0 = b * 64;\
+   int x1 = M_MIN(x0 + 64, width);\
+   int x, y;\
+   for (x = x0; x < x1; x++)\
+      dest[x] = src[x] < 128 ? TMAX : 0;\
+   for (y = 1; y < height; y++) {\
+      const unsigned char *s = src + width * y;\
+      T *d = dest + width * y;\
+      T *dp = d - width;\
+      for (x = x0; x < x1; x++)\
+         d[x] = s[x] < 128 ? (dp[x] == TMAX ? TMAX : dp[x] + 1) : 0;\
+   }\
+   for (y = height - 2; y >= 0; y--) {\
+      T *d = dest + width * y;\
+      T *dn = d + width;\
+      for (x = x0; x < x1; x++)\
+         if (dn[x] != TMAX && dn[x] + 1 < d[x]) d[x] = dn[x] + 1;\
+   }\
+}
+
+/* horizontal pass of one row
+   g: squared column distance (-1 if none), f: squared distance (-1 if none),
+   the lower envelope uses integer separators, columns with no inside pixel are skipped */
+static void m__dist_mask_row(int *f, const int *g, int width, int *sv, int *tv)
+{
+   int q = -1, u;
+
+   for (u = 0; u < width; u++) {
+
+      if (g[u] < 0)
+         continue;
+
+      while (q >= 0 && (tv[q] - sv[q]) * (tv[q] - sv[q]) + g[sv[q]] > (tv[q] - u) * (tv[q] - u) + g[u])
+         q--;
+
+      if (q < 0) {
+         q = 0;
+         sv[0] = u;
+         tv[0] = 0;
+      }
+      else {
+         int i = sv[q];
+         int wv = 1 + ((u * u - i * i) + g[u] - g[i]) / (2 * (u - i));
+         if (wv < width) {
+            q++;
+            sv[q] = u;
+            tv[q] = wv;
+         }
+      }
+   }
+
+   if (q < 0) {
+      for (u = 0; u < width; u++)
+         f[u] = -1;
+      return;
+   }
+
+   for (u = width - 1; u >= 0; u--) {
+      int i = sv[q];
+      f[u] = (u - i) * (u - i) + g[i];
+      if (u == tv[q])
+         q--;
+   }
+}
+
+void m_dist_transform_2d_mask(unsigned int *dest, const unsigned char *src, int width, int height)
+{
+   int band_count = (width + 63) / 64;
+   int b;
+
+   /* vertical pass */
+   #pragma omp parallel for schedule(dynamic, 1)
+   for (b = 0; b < band_count; b++)
+      M_DIST_MASK_COLUMNS(unsigned int, M_DIST_UMAX)
 
    /* horizontal pass */
-   for (y = 0; y < height; y++) {
-      memcpy(tmp1, dest + width * y, width * sizeof(float));
-      m_dist_transform_1d(dest + width * y, tmp1, width);
+   #pragma omp parallel
+   {
+      int *g = (int *)malloc(width * sizeof(int));
+      int *f = (int *)malloc(width * sizeof(int));
+      int *sv = (int *)malloc(width * sizeof(int));
+      int *tv = (int *)malloc(width * sizeof(int));
+      int y;
+
+      #pragma omp for schedule(dynamic, 8)
+      for (y = 0; y < height; y++) {
+
+         unsigned int *d = dest + width * y;
+         int x;
+
+         for (x = 0; x < width; x++)
+            g[x] = d[x] == M_DIST_UMAX ? -1 : (int)(d[x] * d[x]);
+
+         m__dist_mask_row(f, g, width, sv, tv);
+
+         for (x = 0; x < width; x++)
+            d[x] = f[x] < 0 ? M_DIST_UMAX : (unsigned int)f[x];
+      }
+
+      free(tv);
+      free(sv);
+      free(f);
+      free(g);
    }
+}
 
-   free(tmp2);
-   free(tmp1);
-   
+void m_dist_transform_2d_mask_ushort(unsigned short *dest, const unsigned char *src, int width, int height)
+{
+   int band_count = (width + 63) / 64;
+   int b;
+
+   /* vertical pass */
+   #pragma omp parallel for schedule(dynamic, 1)
+   for (b = 0; b < band_count; b++)
+      M_DIST_MASK_COLUMNS(unsigned short, 65535)
+
+   /* horizontal pass */
+   #pragma omp parallel
+   {
+      int *g = (int *)malloc(width * sizeof(int));
+      int *f = (int *)malloc(width * sizeof(int));
+      int *sv = (int *)malloc(width * sizeof(int));
+      int *tv = (int *)malloc(width * sizeof(int));
+      int y;
+
+      #pragma omp for schedule(dynamic, 8)
+      for (y = 0; y < height; y++) {
+
+         unsigned short *d = dest + width * y;
+         int x;
+
+         for (x = 0; x < width; x++)
+            g[x] = d[x] == 65535 ? -1 : (int)d[x] * (int)d[x];
+
+         m__dist_mask_row(f, g, width, sv, tv);
+
+         for (x = 0; x < width; x++)
+            d[x] = (f[x] < 0 || f[x] > 65535) ? 65535 : (unsigned short)f[x];
+      }
+
+      free(tv);
+      free(sv);
+      free(f);
+      free(g);
+   }
 }
 
-void m_voronoi_transform_2d(float *destd, int *desti, float *src, int width, int height)
+#undef M_DIST_MASK_COLUMNS
+
+/* jump flooding seed map, for each pixel: coordinates and value of the closest seed so far
+   (structure of arrays for contiguous loads, w: M_DIST_MAX if no seed) */
+struct m__jfa_map
+{
+   int *x, *y;
+   float *w;
+};
+
+/* one jump flooding pass of step k, from seed map srcm to destm,
+   each pixel tests the seeds of its 8 neighbors at distance k, one neighbor direction at a time over the row,
+   row_err (optional) receives the largest correction of each row (in pixels) */
+static void m__voronoi_jfa_pass(struct m__jfa_map *destm, const struct m__jfa_map *srcm, int width, int height, int k, float *row_err)
+{
+   #pragma omp parallel
+   {
+      float *bd = (float *)malloc(width * sizeof(float));
+      float *cd = (float *)malloc(width * sizeof(float));
+      int y;
+
+      #pragma omp for schedule(dynamic, 8)
+      for (y = 0; y < height; y++) {
+
+         int *dx = destm->x + width * y;
+         int *dy = destm->y + width * y;
+         float *dw = destm->w + width * y;
+         float fy = (float)y;
+         int x, i, j;
+
+         /* current seed */
+         memcpy(dx, srcm->x + width * y, width * sizeof(int));
+         memcpy(dy, srcm->y + width * y, width * sizeof(int));
+         memcpy(dw, srcm->w + width * y, width * sizeof(float));
+         for (x = 0; x < width; x++) {
+            float ex = (float)(x - dx[x]);
+            float ey = fy - (float)dy[x];
+            bd[x] = ex * ex + ey * ey + dw[x];
+         }
+         if (row_err)
+            memcpy(cd, bd, width * sizeof(float));
+
+         /* neighbors */
+         for (j = -k; j <= k; j += k) {
+
+            const int *sx, *sy;
+            const float *sw;
+
+            if (y + j < 0 || y + j >= height)
+               continue;
+
+            sx = srcm->x + width * (y + j);
+            sy = srcm->y + width * (y + j);
+            sw = srcm->w + width * (y + j);
+
+            for (i = -k; i <= k; i += k) {
+
+               int x0 = M_MAX(0, -i);
+               int x1 = M_MIN(width, width - i);
+
+               if (i == 0 && j == 0)
+                  continue;
+
+               for (x = x0; x < x1; x++) {
+                  float ex = (float)(x - sx[x + i]);
+                  float ey = fy - (float)sy[x + i];
+                  float d = ex * ex + ey * ey + sw[x + i];
+                  int closer = d < bd[x];
+                  bd[x] = closer ? d : bd[x];
+                  dx[x] = closer ? sx[x + i] : dx[x];
+                  dy[x] = closer ? sy[x + i] : dy[x];
+                  dw[x] = closer ? sw[x + i] : dw[x];
+               }
+            }
+         }
+
+         if (row_err) {
+            float err = 0;
+            for (x = 0; x < width; x++) {
+               if (cd[x] < M_DIST_MAX && bd[x] < cd[x])
+                  err = M_MAX(err, sqrtf(cd[x]) - sqrtf(bd[x]));
+            }
+            row_err[y] = err;
+         }
+      }
+
+      free(cd);
+      free(bd);
+   }
+}
+
+float m_voronoi_transform_2d_jfa(float *destd, int *desti, float *src, int width, int height, int refine)
+{
+   struct m__jfa_map maps[2];
+   float *row_err = (float *)malloc(height * sizeof(float));
+   int size = width * height;
+   int i, k, cur = 0;
+   float err = -1;
+
+   for (i = 0; i < 2; i++) {
+      maps[i].x = (int *)malloc(size * sizeof(int));
+      maps[i].y = (int *)malloc(size * sizeof(int));
+      maps[i].w = (float *)malloc(size * sizeof(float));
+   }
+
+   /* seeds */
+   #pragma omp parallel for schedule(static)
+   for (i = 0; i < height; i++) {
+      int x;
+      for (x = 0; x < width; x++) {
+         int p = width * i + x;
+         int seed = src[p] < M_DIST_MAX;
+         maps[0].x[p] = seed ? x : 0;
+         maps[0].y[p] = seed ? i : 0;
+         maps[0].w[p] = seed ? src[p] : M_DIST_MAX;
+      }
+   }
+
+   /* jump flooding */
+   k = 1;
+   while (k * 2 < M_MAX(width, height))
+      k *= 2;
+
+   for (; k > 0; k /= 2) {
+      m__voronoi_jfa_pass(&maps[!cur], &maps[cur], width, height, k, NULL);
+      cur = !cur;
+   }
+
+   /* refinement: 1-step passes until no pixel finds a closer seed among its neighbors' */
+   if (refine) {
+      float pass_err;
+      err = 0;
+      do {
+         m__voronoi_jfa_pass(&maps[!cur], &maps[cur], width, height, 1, row_err);
+         cur = !cur;
+         pass_err = 0;
+         for (i = 0; i < height; i++)
+            pass_err = M_MAX(pass_err, row_err[i]);
+         err = M_MAX(err, pass_err);
+      } while (pass_err > 0);
+   }
+
+   /* distance and index */
+   #pragma omp parallel for schedule(dynamic, 8)
+   for (i = 0; i < height; i++) {
+      int x;
+      for (x = 0; x < width; x++) {
+         int p = width * i + x;
+         if (maps[cur].w[p] < M_DIST_MAX) {
+            int dx = x - maps[cur].x[p];
+            int dy = i - maps[cur].y[p];
+            destd[p] = (float)(dx * dx + dy * dy) + maps[cur].w[p];
+            desti[p] = width * maps[cur].y[p] + maps[cur].x[p];
+         }
+         else {
+            destd[p] = src[p];
+            desti[p] = p;
+         }
+      }
+   }
+
+   for (i = 0; i < 2; i++) {
+      free(maps[i].w);
+      free(maps[i].y);
+      free(maps[i].x);
+   }
+   free(row_err);
+   return err;
+}
+
+void m_voronoi_transform_2d_cache(float *destd, int *desti, float *cached, int *cachei, float *src, int width, int height)
+{
+   m__voronoi_transform_2d(destd, desti, cached, cachei, src, width, height);
+}
+
+void m_voronoi_update_2d(float *destd, int *desti, float *cached, int *cachei, float *src, int width, int height, const int *changes, int count)
 {
    int maxs = M_MAX(width, height);
-   float *tmp1 = (float *)malloc(maxs * sizeof(float));
-   float *tmp2 = (float *)malloc(maxs * sizeof(float));
-   int *tmpi1 = (int *)malloc(maxs * sizeof(int));
-   int *tmpi2 = (int *)malloc(width * sizeof(int));
+   int *cols = (int *)malloc(width * sizeof(int));
+   int *rows = (int *)malloc(height * sizeof(int));
+   int *miny = (int *)malloc(width * sizeof(int));
+   int *maxy = (int *)malloc(width * sizeof(int));
+   unsigned char *flags = (unsigned char *)calloc(maxs, 1);
+   int col_count = 0, row_count = 0;
+   int i, y;
+
+   /* list modified columns */
+   for (i = 0; i < count; i++) {
+      int x = changes[i] % width;
+      if (!flags[x]) {
+         flags[x] = 1;
+         cols[col_count++] = x;
+      }
+   }
+
+   memset(flags, 0, maxs);
+
+   /* vertical pass of modified columns,
+      keep the range of rows where the cached result changed */
+   #pragma omp parallel
+   {
+      float *tmp1 = (float *)malloc(height * sizeof(float));
+      float *tmp2 = (float *)malloc(height * sizeof(float));
+      int *tmpi = (int *)malloc(height * sizeof(int));
+      void *ws = malloc(m_dist_workspace_size(height));
+      int c;
+
+      #pragma omp for schedule(dynamic, 1)
+      for (c = 0; c < col_count; c++) {
+
+         int x = cols[c];
+         int y0 = height, y1 = -1;
+         int yi;
+
+         for (yi = 0; yi < height; yi++)
+            tmp1[yi] = src[width * yi + x];
+
+         m_voronoi_transform_1d_ws(tmp2, tmpi, tmp1, height, ws);
+
+         for (yi = 0; yi < height; yi++) {
+            float *d = cached + width * yi + x;
+            int *di = cachei + width * yi + x;
+            if (*d != tmp2[yi] || *di != tmpi[yi]) {
+               *d = tmp2[yi];
+               *di = tmpi[yi];
+               y0 = M_MIN(y0, yi);
+               y1 = yi;
+            }
+         }
+
+         miny[c] = y0;
+         maxy[c] = y1;
+      }
+
+      free(ws);
+      free(tmpi);
+      free(tmp2);
+      free(tmp1);
+   }
+
+   /* list dirty rows */
+   for (i = 0; i < col_count; i++)
+      for (y = miny[i]; y <= maxy[i]; y++)
+         flags[y] = 1;
+
+   for (y = 0; y < height; y++)
+      if (flags[y])
+         rows[row_count++] = y;
+
+   /* horizontal pass of dirty rows */
+   #pragma omp parallel
+   {
+      int *tmpi = (int *)malloc(width * sizeof(int));
+      void *ws = malloc(m_dist_workspace_size(width));
+      int r;
+
+      #pragma omp for schedule(dynamic, 8)
+      for (r = 0; r < row_count; r++) {
+         int offset = width * rows[r];
+         m__voronoi_row(destd + offset, desti + offset, cached + offset, cachei + offset, width, tmpi, ws);
+      }
+
+      free(ws);
+      free(tmpi);
+   }
+
+   free(flags);
+   free(maxy);
+   free(miny);
+   free(rows);
+   free(cols);
+}
+
+/* one separable pass of the 3d transforms:
+   lines of count elements spaced by stride, grouped by blocks of M_DIST_BLOCK adjacent lines,
+   inner: number of adjacent lines, outer: number of groups spaced by outer_stride
+   if desti is not NULL, it is updated with the closest src index (read before written) */
+static void m__dist_pass_3d(float *destd, int *desti, const float *src, int count, int stride, int inner, int outer, int outer_stride)
+{
+   int block_count = (inner + M_DIST_BLOCK - 1) / M_DIST_BLOCK;
+   int task_count = block_count * outer;
+
+   #pragma omp parallel
+   {
+      float *tmp1 = (float *)malloc(M_DIST_BLOCK * count * sizeof(float));
+      float *tmp2 = (float *)malloc(M_DIST_BLOCK * count * sizeof(float));
+      int *tmpi1 = desti ? (int *)malloc(M_DIST_BLOCK * count * sizeof(int)) : NULL;
+      int *tmpi2 = desti ? (int *)malloc(M_DIST_BLOCK * count * sizeof(int)) : NULL;
+      void *ws = malloc(m_dist_workspace_size(count));
+      int t;
+
+      #pragma omp for schedule(dynamic, 1)
+      for (t = 0; t < task_count; t++) {
+
+         int x0 = (t % block_count) * M_DIST_BLOCK;
+         int bw = M_MIN(M_DIST_BLOCK, inner - x0);
+         int base = (t / block_count) * outer_stride + x0;
+         int q, i;
+
+         /* fill lines */
+         for (q = 0; q < count; q++) {
+            const float *line = src + base + q * stride;
+            for (i = 0; i < bw; i++)
+               tmp1[i * count + q] = line[i];
+         }
+
+         if (desti) {
+
+            for (q = 0; q < count; q++) {
+               int *line = desti + base + q * stride;
+               for (i = 0; i < bw; i++)
+                  tmpi2[i * count + q] = line[i];
+            }
+
+            for (i = 0; i < bw; i++)
+               m_voronoi_transform_1d_ws(tmp2 + i * count, tmpi1 + i * count, tmp1 + i * count, count, ws);
+
+            /* copy the result and propagate the closest index */
+            for (q = 0; q < count; q++) {
+               float *line = destd + base + q * stride;
+               int *linei = desti + base + q * stride;
+               for (i = 0; i < bw; i++) {
+                  line[i] = tmp2[i * count + q];
+                  linei[i] = tmpi2[i * count + tmpi1[i * count + q]];
+               }
+            }
+         }
+         else {
+
+            for (i = 0; i < bw; i++)
+               m_dist_transform_1d_ws(tmp2 + i * count, tmp1 + i * count, count, ws);
+
+            /* copy the result */
+            for (q = 0; q < count; q++) {
+               float *line = destd + base + q * stride;
+               for (i = 0; i < bw; i++)
+                  line[i] = tmp2[i * count + q];
+            }
+         }
+      }
+
+      free(ws);
+      if (desti) {
+         free(tmpi2);
+         free(tmpi1);
+      }
+      free(tmp2);
+      free(tmp1);
+   }
+}
+
+void m_dist_transform_3d(float *dest, float *src, int width, int height, int depth)
+{
+   int slice = width * height;
+   m__dist_pass_3d(dest, NULL, src, width, 1, 1, height * depth, width); /* x */
+   m__dist_pass_3d(dest, NULL, dest, height, width, width, depth, slice); /* y */
+   m__dist_pass_3d(dest, NULL, dest, depth, slice, width, height, width); /* z */
+}
+
+void m_voronoi_transform_3d(float *destd, int *desti, float *src, int width, int height, int depth)
+{
+   int slice = width * height;
+   int i, size = slice * depth;
+
+   for (i = 0; i < size; i++)
+      desti[i] = i;
+
+   m__dist_pass_3d(destd, desti, src, width, 1, 1, height * depth, width); /* x */
+   m__dist_pass_3d(destd, desti, destd, height, width, width, depth, slice); /* y */
+   m__dist_pass_3d(destd, desti, destd, depth, slice, width, height, width); /* z */
+}
+
+/* From paper:
+   Anti-aliased Euclidean distance transform
+   by Stefan Gustavson and Robin Strand */
+
+/* seed pixel coordinates, x < 0 if none */
+struct m__dist_seed
+{
    int x, y;
+};
+
+/* smallest relative improvement accepted by the sweeps */
+#define M_SDF_EPSILON 1e-4f
+
+/* the sweeps only refine the pixels closer to the edge than M_SDF_BAND,
+   by blocks of M_SDF_ROWS rows */
+#ifndef M_SDF_BAND
+#define M_SDF_BAND 12.0f
+#endif
+#define M_SDF_ROWS 32
+
+/* edge of a partially covered pixel, relative to the pixel center:
+   segment e + (-ny, nx) * u, u in [u0, u1], (nx, ny): unit normal toward the covered side,
+   or a null normal if the coverage has no orientation */
+struct m__sdf_edge
+{
+   float nx, ny, ex, ey, u0, u1;
+};
+
+/* distance from the center of a pixel of coverage a to the edge crossing it,
+   (gx, gy): edge normal (not normalized) */
+static float m__sdf_offset(float gx, float gy, float a)
+{
+   float l, a1, t;
+
+   if (gx == 0 || gy == 0)
+      return 0.5f - a;
+
+   l = sqrtf(gx * gx + gy * gy);
+   gx = fabsf(gx) / l;
+   gy = fabsf(gy) / l;
+   if (gx < gy) {
+      t = gx; gx = gy; gy = t;
+   }
+
+   a1 = 0.5f * gy / gx;
+   if (a < a1)
+      return 0.5f * (gx + gy) - sqrtf(2.0f * gx * gy * a);
+   else if (a < 1.0f - a1)
+      return (0.5f - a) * gx;
+   else
+      return -0.5f * (gx + gy) + sqrtf(2.0f * gx * gy * (1.0f - a));
+}
+
+/* sub-pixel edge of a pixel of coverage a and unit normal (nx, ny) */
+static void m__sdf_edge_init(struct m__sdf_edge *e, float nx, float ny, float a)
+{
+   float df = m__sdf_offset(nx, ny, a);
+
+   e->nx = nx;
+   e->ny = ny;
+   e->ex = nx * df;
+   e->ey = ny * df;
+
+   /* clip the edge line to the pixel */
+   e->u0 = -M_DIST_MAX;
+   e->u1 = M_DIST_MAX;
+   if (ny != 0) {
+      float t0 = (e->ex - 0.5f) / ny;
+      float t1 = (e->ex + 0.5f) / ny;
+      e->u0 = M_MAX(e->u0, M_MIN(t0, t1));
+      e->u1 = M_MIN(e->u1, M_MAX(t0, t1));
+   }
+   if (nx != 0) {
+      float t0 = (-0.5f - e->ey) / nx;
+      float t1 = (0.5f - e->ey) / nx;
+      e->u0 = M_MAX(e->u0, M_MIN(t0, t1));
+      e->u1 = M_MIN(e->u1, M_MAX(t0, t1));
+   }
+   if (e->u1 < e->u0)
+      e->u0 = e->u1 = (e->u0 + e->u1) * 0.5f;
+}
+
+/* distance from pixel (x, y) to the edge of seed pixel s:
+   seeds of coverage 1 (in their field) are whole pixel squares,
+   partially covered seeds are the segment of their edge inside the pixel,
+   and the seed itself gets its signed distance to the edge line,
+   inner: distance field of the uncovered part (coverage 1 - a, same edge) */
+static float m__sdf_dist(const float *cover, const struct m__sdf_edge *edges, int width, int x, int y, struct m__dist_seed s, int inner)
+{
+   int i = width * s.y + s.x;
+   const struct m__sdf_edge *e = edges + i;
+   float a = cover[i];
+   float dx = (float)(x - s.x);
+   float dy = (float)(y - s.y);
+   float u;
+
+   if (a <= 0.0f || a >= 1.0f) {
+      dx = M_MAX(fabsf(dx) - 0.5f, 0.0f);
+      dy = M_MAX(fabsf(dy) - 0.5f, 0.0f);
+      return sqrtf(dx * dx + dy * dy);
+   }
+
+   if (e->nx == 0 && e->ny == 0) /* no orientation, the edge faces the pixel */
+      return sqrtf(dx * dx + dy * dy) + m__sdf_offset(dx, dy, inner ? 1.0f - a : a);
+
+   if (x == s.x && y == s.y) {
+      float df = e->nx * e->ex + e->ny * e->ey;
+      return inner ? -df : df;
+   }
+
+   u = e->nx * dy - e->ny * dx;
+   u = M_MIN(M_MAX(u, e->u0), e->u1);
+   dx -= e->ex - e->ny * u;
+   dy -= e->ey + e->nx * u;
+   return sqrtf(dx * dx + dy * dy);
+}
+
+/* tests the seed of neighbor pixel (i, j) for pixel p = (x, y) */
+#define M_SDF_TEST(i, j)\
+{\
+   struct m__dist_seed s = seeds[width * (j) + (i)];\
+   if (s.x >= 0 && (s.x != seeds[p].x || s.y != seeds[p].y)) {\
+      float d = m__sdf_dist(cover, edges, width, x, y, s, inner);\
+      if (d < dists[p] - M_SDF_EPSILON * (1.0f + fabsf(dists[p]))) {\
+         dists[p] = d;\
+         seeds[p] = s;\
+         changed++;\
+      }\
+   }\
+}
+
+/* forward raster sweep of row y inside the band (left and upper neighbors, then right neighbor),
+   each pixel keeps the seed with the closest edge, return: number of pixels that changed seed */
+static int m__sdf_row_forward(struct m__dist_seed *seeds, float *dists, const float *cover, const struct m__sdf_edge *edges, int width, int y, int inner)
+{
+   int x, p, changed = 0;
 
-   /* vertical pass */
    for (x = 0; x < width; x++) {
+      p = width * y + x;
+      if (dists[p] <= 0 || dists[p] >= M_SDF_BAND)
+         continue;
+      if (x > 0) M_SDF_TEST(x - 1, y)
+      if (y > 0) {
+         if (x > 0) M_SDF_TEST(x - 1, y - 1)
+         M_SDF_TEST(x, y - 1)
+         if (x < width - 1) M_SDF_TEST(x + 1, y - 1)
+      }
+   }
+   for (x = width - 2; x >= 0; x--) {
+      p = width * y + x;
+      if (dists[p] > 0 && dists[p] < M_SDF_BAND)
+         M_SDF_TEST(x + 1, y)
+   }
+
+   return changed;
+}
+
+/* backward raster sweep of row y inside the band (right and lower neighbors, then left neighbor) */
+static int m__sdf_row_backward(struct m__dist_seed *seeds, float *dists, const float *cover, const struct m__sdf_edge *edges, int width, int height, int y, int inner)
+{
+   int x, p, changed = 0;
+
+   for (x = width - 1; x >= 0; x--) {
+      p = width * y + x;
+      if (dists[p] <= 0 || dists[p] >= M_SDF_BAND)
+         continue;
+      if (x < width - 1) M_SDF_TEST(x + 1, y)
+      if (y < height - 1) {
+         if (x < width - 1) M_SDF_TEST(x + 1, y + 1)
+         M_SDF_TEST(x, y + 1)
+         if (x > 0) M_SDF_TEST(x - 1, y + 1)
+      }
+   }
+   for (x = 1; x < width; x++) {
+      p = width * y + x;
+      if (dists[p] > 0 && dists[p] < M_SDF_BAND)
+         M_SDF_TEST(x - 1, y)
+   }
+
+   return changed;
+}
+
+/* forward and backward raster sweep of the rows [y0, y1) (from = 0),
+   or of the rows reached from a change of row y0 - 1 (from & 1) or of row y1 (from & 2),
+   until the first stable row,
+   return: 1 if row y0 changed + 2 if row y1 - 1 changed */
+static int m__sdf_sweep(struct m__dist_seed *seeds, float *dists, const float *cover, const struct m__sdf_edge *edges, int width, int height, int y0, int y1, int inner, int from)
+{
+   int y, ya, yb, border = 0;
+
+   /* downward from row y0 */
+   if (from == 0 || (from & 1)) {
+      for (yb = y0; yb < y1; yb++) {
+         if (m__sdf_row_forward(seeds, dists, cover, edges, width, yb, inner))
+            border |= (yb == y0) | ((yb == y1 - 1) << 1);
+         else if (from && yb > y0)
+            break;
+      }
+      for (y = M_MIN(yb, y1 - 1); y >= y0; y--) {
+         if (m__sdf_row_backward(seeds, dists, cover, edges, width, height, y, inner))
+            border |= (y == y0) | ((y == y1 - 1) << 1);
+      }
+   }
+
+   /* upward from row y1 - 1 */
+   if (from & 2) {
+      for (ya = y1 - 1; ya >= y0; ya--) {
+         if (m__sdf_row_backward(seeds, dists, cover, edges, width, height, ya, inner))
+            border |= (ya == y0) | ((ya == y1 - 1) << 1);
+         else if (ya < y1 - 1)
+            break;
+      }
+      for (y = M_MAX(ya, y0); y < y1; y++) {
+         if (m__sdf_row_forward(seeds, dists, cover, edges, width, y, inner))
+            border |= (y == y0) | ((y == y1 - 1) << 1);
+      }
+   }
+
+   return border;
+}
+
+#undef M_SDF_TEST
+
+/* the inside and outside fields share the column gather and parallel passes:
+   an exact voronoi of the pixel centers on each side of the 0.5 iso-line gives the initial seeds
+   (partially covered pixels start from their own edge),
+   then raster sweeps move the pixels near the edge to the seed with the closest sub-pixel edge */
+static void m__signed_dist_transform_2d(float *dest, const float *fsrc, const unsigned char *usrc, int width, int height)
+{
+   struct m__dist_seed *seeds[2];
+   float *dists[2];
+   struct m__sdf_edge *edges;
+   float *cover;
+   int size = width * height;
+   int maxs = M_MAX(width, height);
+   int block_count = (width + M_DIST_BLOCK - 1) / M_DIST_BLOCK;
+   int row_count = (height + M_SDF_ROWS - 1) / M_SDF_ROWS;
+   int *stamps, idle, pass, i;
+   int high = 0, low = 0;
+   float omin, imax;
+
+   cover = (float *)malloc(size * sizeof(float));
+   edges = (struct m__sdf_edge *)malloc(size * sizeof(struct m__sdf_edge));
+   seeds[0] = (struct m__dist_seed *)malloc(size * sizeof(struct m__dist_seed));
+   seeds[1] = (struct m__dist_seed *)malloc(size * sizeof(struct m__dist_seed));
+   dists[0] = dest; /* outside */
+   dists[1] = (float *)malloc(size * sizeof(float)); /* inside */
 
-      /* fill vertical line */
-      for (y = 0; y < height; y++)
-         tmp1[y] = *(src + width * y + x);
+   /* a field without pixel on its side of the iso-line is seeded from all its pixels */
+   #pragma omp parallel for schedule(static) reduction(|:high, low)
+   for (i = 0; i < size; i++) {
+      float a = fsrc ? fsrc[i] : usrc[i] * (1.0f / 255.0f);
+      high |= a >= 0.5f;
+      low |= a < 0.5f;
+   }
+   omin = high ? 0.5f : 0.0f;
+   imax = low ? 0.5f : 1.0f;
+
+   #pragma omp parallel
+   {
+      float *tmpo = (float *)malloc(M_MAX(M_DIST_BLOCK * height, width) * sizeof(float));
+      float *tmpi = (float *)malloc(M_MAX(M_DIST_BLOCK * height, width) * sizeof(float));
+      float *tmp2 = (float *)malloc(M_DIST_BLOCK * height * sizeof(float));
+      int *tmpv = (int *)malloc(M_MAX(M_DIST_BLOCK * height, width) * sizeof(int));
+      int *tmpy = (int *)malloc(width * sizeof(int));
+      void *ws = malloc(m_dist_workspace_size(maxs));
+      int b, y, n;
+
+      /* vertical pass */
+      #pragma omp for schedule(dynamic, 1)
+      for (b = 0; b < block_count; b++) {
+
+         int x0 = b * M_DIST_BLOCK;
+         int bw = M_MIN(M_DIST_BLOCK, width - x0);
+         int x, k;
+
+         /* seed both fields from the mask:
+            the outside field from the pixels covered at least halfway, the inside field from the others */
+         for (y = 0; y < height; y++) {
+            int offset = width * y + x0;
+            for (k = 0; k < bw; k++) {
+               float a = fsrc ? fsrc[offset + k] : usrc[offset + k] * (1.0f / 255.0f);
+               a = M_MIN(M_MAX(a, 0.0f), 1.0f);
+               cover[offset + k] = a;
+               tmpo[k * height + y] = (a > 0.0f && a >= omin) ? 0 : M_DIST_MAX;
+               tmpi[k * height + y] = a < imax ? 0 : M_DIST_MAX;
+            }
+         }
+
+         for (n = 0; n < 2; n++) {
+
+            float *tmp1 = n ? tmpi : tmpo;
+
+            for (k = 0; k < bw; k++)
+               m_voronoi_transform_1d_ws(tmp2 + k * height, tmpv + k * height, tmp1 + k * height, height, ws);
+
+            /* copy the result (distance and closest row) */
+            for (y = 0; y < height; y++) {
+               float *rowd = dists[n] + width * y + x0;
+               struct m__dist_seed *rows = seeds[n] + width * y + x0;
+               for (x = 0; x < bw; x++) {
+                  rowd[x] = tmp2[x * height + y];
+                  rows[x].y = tmpv[x * height + y];
+               }
+            }
+         }
+      }
+
+      /* edges of the partially covered pixels (normal from the sobel gradient, clamped to the borders) */
+      #pragma omp for schedule(dynamic, 8)
+      for (y = 0; y < height; y++) {
+
+         const float *r0 = cover + width * M_MAX(y - 1, 0);
+         const float *r1 = cover + width * y;
+         const float *r2 = cover + width * M_MIN(y + 1, height - 1);
+         struct m__sdf_edge *rowe = edges + width * y;
+         int x;
+
+         for (x = 0; x < width; x++) {
 
-      m_voronoi_transform_1d(tmp2, tmpi1, tmp1, height);
+            int x0 = M_MAX(x - 1, 0);
+            int x2 = M_MIN(x + 1, width - 1);
+            float gx, gy, l;
+
+            if (r1[x] <= 0.0f || r1[x] >= 1.0f)
+               continue;
+
+            gx = (r0[x2] + r2[x2] - r0[x0] - r2[x0]) + 1.41421356f * (r1[x2] - r1[x0]);
+            gy = (r2[x0] + r2[x2] - r0[x0] - r0[x2]) + 1.41421356f * (r2[x] - r0[x]);
+            l = sqrtf(gx * gx + gy * gy);
+            if (l > 0)
+               m__sdf_edge_init(rowe + x, gx / l, gy / l, r1[x]);
+            else
+               rowe[x].nx = rowe[x].ny = 0;
+         }
+      }
 
-      /* copy the result */
+      /* horizontal pass and initial edge distance */
+      #pragma omp for schedule(dynamic, 8)
       for (y = 0; y < height; y++) {
-         *(destd + width * y + x) = tmp2[y];
-         *(desti + width * y + x) = tmpi1[y];
+
+         for (n = 0; n < 2; n++) {
+
+            struct m__dist_seed *rows = seeds[n] + width * y;
+            float *rowd = dists[n] + width * y;
+            int x;
+
+            /* copy distance and closest row of current line */
+            memcpy(tmpo, rowd, width * sizeof(float));
+            for (x = 0; x < width; x++)
+               tmpy[x] = rows[x].y;
+
+            m_voronoi_transform_1d_ws(tmpi, tmpv, tmpo, width, ws);
+
+            for (x = 0; x < width; x++) {
+               float a = cover[width * y + x];
+               if (a > 0.0f && a < 1.0f) { /* own edge */
+                  rows[x].x = x;
+                  rows[x].y = y;
+                  rowd[x] = m__sdf_dist(cover, edges, width, x, y, rows[x], n);
+               }
+               else if (tmpi[x] < M_DIST_MAX) {
+                  rows[x].x = tmpv[x];
+                  rows[x].y = tmpy[tmpv[x]];
+                  rowd[x] = m__sdf_dist(cover, edges, width, x, y, rows[x], n);
+               }
+               else {
+                  rows[x].x = -1;
+                  rows[x].y = -1;
+                  rowd[x] = M_DIST_MAX;
+               }
+            }
+         }
       }
+
+      free(ws);
+      free(tmpy);
+      free(tmpv);
+      free(tmp2);
+      free(tmpi);
+      free(tmpo);
    }
 
-   /* horizontal pass */
-   for (y = 0; y < height; y++) {
+   /* sweep both fields by blocks of rows, even and odd blocks in turn (a block reads the border rows
+      of its neighbors while they wait), a block is swept again when a neighbor changed its border row */
+   stamps = (int *)malloc(row_count * 6 * sizeof(int)); /* per field and block: last sweep, first and last row changes */
+   for (i = 0; i < row_count * 6; i++)
+      stamps[i] = -1;
 
-      /* copy distance and index of current line */
-      memcpy(tmp1, destd + width * y, width * sizeof(float));
-      memcpy(tmpi2, desti + width * y, width * sizeof(int));
-      
-      m_voronoi_transform_1d(destd + width * y, tmpi1, tmp1, width);
+   for (pass = 0, idle = 0; idle < 2; pass++) {
 
-      /* compute 2d closest pixel index */
-      for (x = 0; x < width; x++) {
-         int _x = tmpi1[x];
-         int _y = tmpi2[_x];
-         *(desti + width * y + x) = _y * width + _x;
+      int count = 0, b;
+
+      #pragma omp parallel for schedule(dynamic, 1) reduction(+:count)
+      for (b = pass & 1; b < row_count; b += 2) {
+
+         int f;
+         for (f = 0; f < 2; f++) {
+
+            int *st = stamps + (row_count * f + b) * 3;
+            int from = 0, border;
+
+            if (st[0] >= 0) {
+               int top = b > 0 && st[-1] > st[0];
+               int bottom = b < row_count - 1 && st[4] > st[0];
+               if (!top && !bottom)
+                  continue;
+               from = top | (bottom << 1);
+            }
+
+            border = m__sdf_sweep(seeds[f], dists[f], cover, edges, width, height, b * M_SDF_ROWS, M_MIN((b + 1) * M_SDF_ROWS, height), f, from);
+            st[0] = pass;
+            if (border & 1) st[1] = pass;
+            if (border & 2) st[2] = pass;
+            count++;
+         }
       }
+
+      idle = count > 0 ? 0 : idle + 1;
+   }
+
+   free(stamps);
+
+   /* combine */
+   #pragma omp parallel for schedule(static)
+   for (i = 0; i < size; i++) {
+      float d0 = dists[0][i] < M_DIST_MAX ? M_MAX(dists[0][i], 0.0f) : sqrtf(M_DIST_MAX);
+      float d1 = dists[1][i] < M_DIST_MAX ? M_MAX(dists[1][i], 0.0f) : sqrtf(M_DIST_MAX);
+      dest[i] = d0 - d1;
    }
 
-   free(tmpi2);
-   free(tmpi1);
-   free(tmp2);
-   free(tmp1);
+   free(dists[1]);
+   free(seeds[1]);
+   free(seeds[0]);
+   free(edges);
+   free(cover);
+}
+
+void m_signed_dist_transform_2d(float *dest, float *src, int width, int height)
+{
+   m__signed_dist_transform_2d(dest, src, NULL, width, height);
 }
 
 #ifdef M_IMAGE_VERSION
@@ -266,6 +1376,29 @@ void m_image_dist_transform(struct m_image *dest, const struct m_image *src)
       dest_data[i] = sqrtf(dest_data[i]);
 }
 
+void m_image_dist_transform_mask(struct m_image *dest, const struct m_image *src, char type)
+{
+   assert(src->size > 0 && src->type == M_UBYTE && src->comp == 1);
+   assert(type == M_UINT || type == M_USHORT);
+   m_image_create(dest, type, src->width, src->height, 1);
+
+   if (type == M_UINT)
+      m_dist_transform_2d_mask((unsigned int *)dest->data, (unsigned char *)src->data, src->width, src->height);
+   else
+      m_dist_transform_2d_mask_ushort((unsigned short *)dest->data, (unsigned char *)src->data, src->width, src->height);
+}
+
+void m_image_signed_dist_transform(struct m_image *dest, const struct m_image *src)
+{
+   assert(src->size > 0 && (src->type == M_UBYTE || src->type == M_FLOAT) && src->comp == 1);
+   m_image_create(dest, M_FLOAT, src->width, src->height, 1);
+
+   if (src->type == M_FLOAT)
+      m__signed_dist_transform_2d((float *)dest->data, (float *)src->data, NULL, src->width, src->height);
+   else
+      m__signed_dist_transform_2d((float *)dest->data, NULL, (unsigned char *)src->data, src->width, src->height);
+}
+
 void m_image_voronoi_transform(struct m_image *destd, struct m_image *desti, const struct m_image *src)
 {
    float *dest_data;
@@ -286,52 +1419,114 @@ void m_image_voronoi_transform(struct m_image *destd, struct m_image *desti, con
       dest_data[i] = sqrtf(dest_data[i]);
 }
 
-void m_image_voronoi_fill(struct m_image *dest, const struct m_image *src, const struct m_image *srci)
+float m_image_voronoi_transform_jfa(struct m_image *destd, struct m_image *desti, const struct m_image *src, int refine)
+{
+   float *dest_data;
+   int width = src->width;
+   int height = src->height;
+   int size = src->size;
+   float err;
+   int i;
+
+   assert(src->size > 0 && src->type == M_FLOAT && src->comp == 1);
+   m_image_create(destd, M_FLOAT, width, height, 1);
+   m_image_create(desti, M_INT, width, height, 1);
+   dest_data = (float *)destd->data;
+
+   /* jump flooding */
+   err = m_voronoi_transform_2d_jfa(dest_data, (int *)desti->data, (float *)src->data, width, height, refine);
+
+   for (i = 0; i < size; i++)
+      dest_data[i] = sqrtf(dest_data[i]);
+
+   return err;
+}
+
+/* fill one row with whole-pixel copies specialized by pixel size in bytes,
+   (ubyte RGBA and float 1 are copied as 32 bit words, float 3 and 4 as 3 and 4 words) */
+static void m__voronoi_fill_row(void *dest, const void *src, const int *index, int count, int pixel_size)
 {
-   #define M_VORO_FILL(T)\
+   #define M_VORO_FILL_ROW(T, N)\
    {\
-      T *sData = (T *)src->data;\
-      T *dData = (T *)dest->data;\
+      T *dData = (T *)dest;\
+      const T *sData = (const T *)src;\
       int i, c;\
-      for (i = 0; i < size; i++) {\
-         for (c = 0; c < comp; c++) {\
-            (*dData) = sData[(*datai) * comp + c];\
-            dData++;\
-         }\
-         datai++;\
+      for (i = 0; i < count; i++) {\
+         const T *sp = sData + index[i] * N;\
+         for (c = 0; c < N; c++)\
+            dData[c] = sp[c];\
+         dData += N;\
       }\
    }
 
-   int *datai = (int *)srci->data;
-   int comp = src->comp;
-   int size = srci->size;
-
-   m_image_create(dest, src->type, src->width, src->height, src->comp);
-
-   switch(src->type)
+   switch (pixel_size)
    {
-   case M_BYTE:
-   case M_UBYTE:
-      M_VORO_FILL(char);
+   case 1:
+      M_VORO_FILL_ROW(uint8_t, 1);
+      break;
+   case 2:
+      M_VORO_FILL_ROW(uint16_t, 1);
       break;
-   case M_SHORT:
-   case M_USHORT:
-   case M_HALF:
-      M_VORO_FILL(short);
+   case 3:
+      M_VORO_FILL_ROW(uint8_t, 3);
       break;
-   case M_INT:
-   case M_UINT:
-      M_VORO_FILL(int);
+   case 4:
+      M_VORO_FILL_ROW(uint32_t, 1);
       break;
-   case M_FLOAT:
-      M_VORO_FILL(float);
+   case 8:
+      M_VORO_FILL_ROW(uint32_t, 2);
+      break;
+   case 12:
+      M_VORO_FILL_ROW(uint32_t, 3);
+      break;
+   case 16:
+      M_VORO_FILL_ROW(uint32_t, 4);
       break;
    default:
-      assert(0);
+   {
+      uint8_t *dData = (uint8_t *)dest;
+      const uint8_t *sData = (const uint8_t *)src;
+      int i;
+      for (i = 0; i < count; i++) {
+         memcpy(dData, sData + index[i] * pixel_size, pixel_size);
+         dData += pixel_size;
+      }
       break;
    }
-   
-   #undef M_VORO_FILL
+   }
+
+   #undef M_VORO_FILL_ROW
+}
+
+void m_image_voronoi_fill_multi(struct m_image *dest, const struct m_image *src, int count, const struct m_image *srci)
+{
+   int *datai = (int *)srci->data;
+   int width = srci->width;
+   int height = srci->height;
+   int k, y;
+
+   for (k = 0; k < count; k++) {
+      assert(src[k].width == width && src[k].height == height);
+      m_image_create(&dest[k], src[k].type, width, height, src[k].comp);
+   }
+
+   /* one pass over the index map, every image is filled while its row is hot */
+   #pragma omp parallel for schedule(dynamic, 8)
+   for (y = 0; y < height; y++) {
+
+      const int *index = datai + width * y;
+      int i;
+
+      for (i = 0; i < count; i++) {
+         int pixel_size = m_type_sizeof(src[i].type) * src[i].comp;
+         m__voronoi_fill_row((uint8_t *)dest[i].data + width * y * pixel_size, src[i].data, index, width, pixel_size);
+      }
+   }
+}
+
+void m_image_voronoi_fill(struct m_image *dest, const struct m_image *src, const struct m_image *srci)
+{
+   m_image_voronoi_fill_multi(dest, src, 1, srci);
 }
 
 #endif /* M_IMAGE_VERSION */
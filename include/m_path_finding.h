@@ -52,18 +52,162 @@ struct m_pf_point
 
 /* floodfill a score map from destination (x, y)
    the input map is filled with this two values: 0 = ground, UINT_MAX = wall
-   *stack should be at least of size (w * h) */
+   *stack should be at least of size (w * h + 1), the destination is visited twice */
 MPFAPI void m_pf_floodfill(unsigned int *map, int w, int h, int x, int y, struct m_pf_point *stack);
 
 /* backtrace a path from start (x, y) */
 MPFAPI int m_pf_backtrace(struct m_pf_point *dest, const unsigned int *map, int w, int h, int x, int y);
 
+/* flow field (many agents, one or several goals)
+   seeds: goals flooded together, map receives the distance to the nearest seed (seeds = 1)
+   dir receives a packed direction per cell (see M_PF_FLOW_DX / M_PF_FLOW_DY),
+   or M_PF_FLOW_NONE on walls, unreachable cells and seeds (diagonals never cut corners)
+   *stack should be at least of size (w * h) */
+#define M_PF_FLOW_NONE 0xFF
+#define M_PF_FLOW_DX(d) ((int)((d) & 3) - 1)
+#define M_PF_FLOW_DY(d) ((int)(((d) >> 2) & 3) - 1)
+
+MPFAPI void m_pf_floodfill_multi(unsigned int *map, int w, int h, const struct m_pf_point *seeds, int seed_count, struct m_pf_point *stack);
+MPFAPI void m_pf_flow_field(unsigned char *dir, unsigned int *map, int w, int h, const struct m_pf_point *seeds, int seed_count, struct m_pf_point *stack);
+
+/* weighted floodfill (Dijkstra) from destination (x, y)
+   cost: cost of entering each cell (0 = wall, negative = wall for float)
+   dist: output distance (UINT_MAX or M_PF_FLOAT_MAX if unreachable),
+   a straight step costs cost * M_PF_COST_STRAIGHT and a diagonal step cost * M_PF_COST_DIAGONAL
+   connectivity: 4 or 8 (no corner cutting)
+   the ubyte version uses a bucket queue (Dial), the float version a radix heap */
+#define M_PF_FLOAT_MAX 1e20f
+
+MPFAPI void m_pf_dijkstra_ubyte(unsigned int *dist, const unsigned char *cost, int w, int h, int x, int y, int connectivity);
+MPFAPI void m_pf_dijkstra_float(float *dist, const float *cost, int w, int h, int x, int y, int connectivity);
+
+/* A* search */
+#define M_PF_MANHATTAN 0 /* 4-connectivity */
+#define M_PF_OCTILE    1 /* 8-connectivity (no corner cutting) */
+
+#define M_PF_COST_STRAIGHT 10
+#define M_PF_COST_DIAGONAL 14
+
+struct m_pf_heap_node
+{
+   unsigned int f, g;
+   int i;
+};
+
+struct m_pf_heap
+{
+   struct m_pf_heap_node *data;
+   int count, size;
+};
+
+/* reusable search context (for a given grid size),
+   repeated queries allocate nothing once the heap has grown */
+struct m_pf_context
+{
+   unsigned int *g;
+   unsigned int *stamp;
+   unsigned char *dir;
+   struct m_pf_heap heap;
+   unsigned int search;
+   int w, h;
+};
+
+MPFAPI void m_pf_context_create(struct m_pf_context *ctx, int w, int h);
+MPFAPI void m_pf_context_destroy(struct m_pf_context *ctx);
+
+/* find a path from start (x0, y0) to goal (x1, y1)
+   the input map is read only: UINT_MAX = wall, any other value = ground
+   heuristic: M_PF_MANHATTAN or M_PF_OCTILE
+   dest receives the path after start up to goal included (at most max_count points)
+   return the path length (can be greater than max_count), 0 if no path was found */
+MPFAPI int m_pf_astar(struct m_pf_context *ctx, struct m_pf_point *dest, int max_count, const unsigned int *map, int x0, int y0, int x1, int y1, int heuristic);
+
+/* Jump Point Search (uniform-cost grid, 8-connectivity, no corner cutting)
+   same map, arguments and output as m_pf_astar with M_PF_OCTILE,
+   the path is expanded to every cell between jump points */
+MPFAPI int m_pf_jps(struct m_pf_context *ctx, struct m_pf_point *dest, int max_count, const unsigned int *map, int x0, int y0, int x1, int y1);
+
+/* hierarchical path finding (HPA*, 8-connectivity, no corner cutting)
+   the map is divided in clusters of cluster_size cells (clamped to 8 to 32),
+   entrances between clusters and their intra-cluster costs are precomputed,
+   queries search the abstract graph then refine locally:
+   paths are not optimal, they only cross clusters at entrance cells
+   (about 3 to 4% longer than m_pf_astar on average, much more on some short paths) */
+#define M_PF_HPA_MIN_CLUSTER 8
+#define M_PF_HPA_MAX_CLUSTER 32
+#define M_PF_HPA_MAX_NODES (4 * M_PF_HPA_MAX_CLUSTER)
+
+struct m_pf_hpa_cluster
+{
+   int *cells;           /* abstract node cells */
+   unsigned char *sides; /* border of each node (0: top, 1: left, 2: right, 3: bottom) */
+   unsigned int *costs;  /* count * count intra-cluster costs (UINT_MAX = unreachable) */
+   unsigned int *g;      /* abstract search state */
+   unsigned int *stamp;
+   int *parent;
+   int count, size;
+};
+
+struct m_pf_hpa
+{
+   const unsigned int *map;
+   struct m_pf_hpa_cluster *clusters;
+   struct m_pf_context ctx;
+   struct m_pf_heap heap;
+   int *path;
+   int path_size;
+   unsigned int search;
+   int w, h, cluster_size, cw, ch;
+};
+
+/* build the cluster graph of map (kept by reference), clusters are built in parallel with OpenMP */
+MPFAPI void m_pf_hpa_create(struct m_pf_hpa *hpa, const unsigned int *map, int w, int h, int cluster_size);
+MPFAPI void m_pf_hpa_destroy(struct m_pf_hpa *hpa);
+
+/* rebuild the clusters touched by a map edit inside the rect (x, y, w, h) */
+MPFAPI void m_pf_hpa_update(struct m_pf_hpa *hpa, int x, int y, int w, int h);
+
+/* same output as m_pf_astar */
+MPFAPI int m_pf_hpa_find(struct m_pf_hpa *hpa, struct m_pf_point *dest, int max_count, int x0, int y0, int x1, int y1);
+
+/* incremental distance field (LPA*, goal rooted, no heuristic)
+   same cost map, units and connectivity as m_pf_dijkstra_ubyte (kept by reference),
+   after an edit of the cost map, notify the changed cells then call m_pf_lpa_compute:
+   only the part of the field affected by the change is repaired,
+   g is the distance field (equal to m_pf_dijkstra_ubyte output after compute) */
+struct m_pf_lpa
+{
+   const unsigned char *cost;
+   unsigned int *g;
+   unsigned int *rhs;
+   struct m_pf_heap heap;
+   int w, h, goal, connectivity;
+};
+
+MPFAPI void m_pf_lpa_create(struct m_pf_lpa *lpa, const unsigned char *cost, int w, int h, int x, int y, int connectivity);
+MPFAPI void m_pf_lpa_destroy(struct m_pf_lpa *lpa);
+
+/* cost[w * y + x] has changed */
+MPFAPI void m_pf_lpa_notify(struct m_pf_lpa *lpa, int x, int y);
+
+/* repair the distance field, return the number of expanded cells */
+MPFAPI int m_pf_lpa_compute(struct m_pf_lpa *lpa);
+
+/* steepest descent from (x, y) to the goal (compute first),
+   same output as m_pf_astar */
+MPFAPI int m_pf_lpa_path(struct m_pf_lpa *lpa, struct m_pf_point *dest, int max_count, int x, int y);
+
 #endif /* M_PF_H */
 
 #ifdef M_PF_IMPLEMENTATION
 
+#include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
+#define M_PF_MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define M_PF_MAX(a, b) (((a) > (b)) ? (a) : (b))
+
 #define M_PF_PUSH_PIXEL(x2, y2)\
 if(map[w * (y2) + (x2)] == 0) {\
    stack[stack_n].x = (x2);\
@@ -122,7 +266,8 @@ MPFAPI int m_pf_backtrace(struct m_pf_point *dest, const unsigned int *map, int
          p = map + (yi * w + minx);
          for (xi = minx; xi < maxx; xi++) {
 
-            if (*p < min) {
+            /* 0: not reached by the floodfill */
+            if (*p < min && *p != 0) {
                min = *p;
                y = yi;
                x = xi;
@@ -141,6 +286,1365 @@ MPFAPI int m_pf_backtrace(struct m_pf_point *dest, const unsigned int *map, int
    return 0;
 }
 
+/* 4 straight then 4 diagonal directions */
+static const int m__pf_dx[8] = {0, -1, 1, 0, -1, 1, -1, 1};
+static const int m__pf_dy[8] = {-1, 0, 0, 1, -1, -1, 1, 1};
+
+/* binary min-heap on f (lazy deletion: stale nodes are skipped by the caller) */
+static void m__pf_heap_push(struct m_pf_heap *heap, unsigned int f, unsigned int g, int i)
+{
+   struct m_pf_heap_node *data;
+   int c, p;
+
+   if (heap->count == heap->size) {
+      heap->size = heap->size > 0 ? heap->size * 2 : 1024;
+      heap->data = (struct m_pf_heap_node *)realloc(heap->data, heap->size * sizeof(struct m_pf_heap_node));
+   }
+
+   data = heap->data;
+   c = heap->count++;
+
+   while (c > 0) {
+      p = (c - 1) / 2;
+      if (data[p].f <= f)
+         break;
+      data[c] = data[p];
+      c = p;
+   }
+
+   data[c].f = f;
+   data[c].g = g;
+   data[c].i = i;
+}
+
+static struct m_pf_heap_node m__pf_heap_pop(struct m_pf_heap *heap)
+{
+   struct m_pf_heap_node *data = heap->data;
+   struct m_pf_heap_node top = data[0];
+   struct m_pf_heap_node last = data[--heap->count];
+   int count = heap->count;
+   int p = 0, c = 1;
+
+   while (c < count) {
+      if (c + 1 < count && data[c + 1].f < data[c].f)
+         c++;
+      if (last.f <= data[c].f)
+         break;
+      data[p] = data[c];
+      p = c;
+      c = p * 2 + 1;
+   }
+
+   if (count > 0)
+      data[p] = last;
+
+   return top;
+}
+
+MPFAPI void m_pf_context_create(struct m_pf_context *ctx, int w, int h)
+{
+   int size = w * h;
+   ctx->g = (unsigned int *)malloc(size * sizeof(unsigned int));
+   ctx->stamp = (unsigned int *)calloc(size, sizeof(unsigned int));
+   ctx->dir = (unsigned char *)malloc(size);
+   ctx->heap.data = NULL;
+   ctx->heap.count = 0;
+   ctx->heap.size = 0;
+   ctx->search = 0;
+   ctx->w = w;
+   ctx->h = h;
+}
+
+MPFAPI void m_pf_context_destroy(struct m_pf_context *ctx)
+{
+   free(ctx->heap.data);
+   free(ctx->dir);
+   free(ctx->stamp);
+   free(ctx->g);
+}
+
+MPFAPI void m_pf_floodfill_multi(unsigned int *map, int w, int h, const struct m_pf_point *seeds, int seed_count, struct m_pf_point *stack)
+{
+   unsigned int i = 1;
+   int stack_c = 0;
+   int stack_n = 0;
+   int x, y, s;
+
+   for (s = 0; s < seed_count; s++)
+      M_PF_PUSH_PIXEL(seeds[s].x, seeds[s].y)
+
+   while (stack_c < stack_n) {
+
+      x = stack[stack_c].x;
+      y = stack[stack_c].y;
+      i = map[w * y + x] + 1;
+      stack_c++;
+
+      if (y > 0)
+         M_PF_PUSH_PIXEL(x, y - 1)
+      if (x > 0)
+         M_PF_PUSH_PIXEL(x - 1, y)
+      if (x < (w - 1))
+         M_PF_PUSH_PIXEL(x + 1, y)
+      if (y < (h - 1))
+         M_PF_PUSH_PIXEL(x, y + 1)
+   }
+}
+
+MPFAPI void m_pf_flow_field(unsigned char *dir, unsigned int *map, int w, int h, const struct m_pf_point *seeds, int seed_count, struct m_pf_point *stack)
+{
+   int y;
+
+   m_pf_floodfill_multi(map, w, h, seeds, seed_count, stack);
+
+   /* steepest descent, straight steps first then diagonals */
+   #pragma omp parallel for schedule(dynamic, 8)
+   for (y = 0; y < h; y++) {
+
+      const unsigned int *row = map + w * y;
+      unsigned char *drow = dir + w * y;
+      int x;
+
+      for (x = 0; x < w; x++) {
+
+         unsigned int min = row[x];
+         unsigned char d = M_PF_FLOW_NONE;
+         int k;
+
+         if (min == 0 || min == UINT_MAX) {
+            drow[x] = M_PF_FLOW_NONE;
+            continue;
+         }
+
+         for (k = 0; k < 8; k++) {
+
+            int dx = m__pf_dx[k];
+            int dy = m__pf_dy[k];
+            int xn = x + dx;
+            int yn = y + dy;
+            unsigned int v;
+
+            if (xn < 0 || yn < 0 || xn >= w || yn >= h)
+               continue;
+
+            v = map[w * yn + xn];
+            if (v >= min || v == 0)
+               continue;
+
+            if (k >= 4 && (row[xn] == UINT_MAX || map[w * yn + x] == UINT_MAX))
+               continue;
+
+            min = v;
+            d = (unsigned char)((dx + 1) | ((dy + 1) << 2));
+         }
+
+         drow[x] = d;
+      }
+   }
+}
+
+/* bucket queue (Dial): edges cost at most 255 * M_PF_COST_DIAGONAL,
+   so (max edge + 1) circular buckets are enough, stale entries are skipped */
+struct m_pf_bucket
+{
+   int *data;
+   int count, size;
+};
+
+MPFAPI void m_pf_dijkstra_ubyte(unsigned int *dist, const unsigned char *cost, int w, int h, int x, int y, int connectivity)
+{
+   int bucket_count = 255 * M_PF_COST_DIAGONAL + 1;
+   struct m_pf_bucket *buckets = (struct m_pf_bucket *)calloc(bucket_count, sizeof(struct m_pf_bucket));
+   int dir_count = connectivity == 8 ? 8 : 4;
+   int size = w * h;
+   int pending = 0;
+   unsigned int d;
+   int i;
+
+   for (i = 0; i < size; i++)
+      dist[i] = UINT_MAX;
+
+   if (cost[w * y + x] == 0)
+      goto end;
+
+   dist[w * y + x] = 0;
+   buckets[0].data = (int *)malloc(sizeof(int));
+   buckets[0].data[0] = w * y + x;
+   buckets[0].count = buckets[0].size = 1;
+   pending = 1;
+
+   for (d = 0; pending > 0; d++) {
+
+      struct m_pf_bucket *bucket = &buckets[d % bucket_count];
+
+      /* the bucket can grow while it is processed (zero-cost edges do not exist) */
+      for (i = 0; i < bucket->count; i++) {
+
+         int c = bucket->data[i];
+         int cx = c % w;
+         int cy = c / w;
+         unsigned int step = cost[c];
+         int k;
+
+         pending--;
+         if (dist[c] != d) /* stale */
+            continue;
+
+         for (k = 0; k < dir_count; k++) {
+
+            int xn = cx + m__pf_dx[k];
+            int yn = cy + m__pf_dy[k];
+            unsigned int dn;
+            struct m_pf_bucket *bn;
+            int n;
+
+            if (xn < 0 || yn < 0 || xn >= w || yn >= h)
+               continue;
+
+            n = w * yn + xn;
+            if (cost[n] == 0)
+               continue;
+
+            if (k < 4)
+               dn = d + step * M_PF_COST_STRAIGHT;
+            else {
+               if (cost[w * cy + xn] == 0 || cost[w * yn + cx] == 0)
+                  continue;
+               dn = d + step * M_PF_COST_DIAGONAL;
+            }
+
+            if (dn >= dist[n])
+               continue;
+
+            dist[n] = dn;
+            bn = &buckets[dn % bucket_count];
+            if (bn->count == bn->size) {
+               bn->size = bn->size > 0 ? bn->size * 2 : 16;
+               bn->data = (int *)realloc(bn->data, bn->size * sizeof(int));
+            }
+            bn->data[bn->count++] = n;
+            pending++;
+         }
+      }
+
+      bucket->count = 0;
+   }
+
+end:
+   for (i = 0; i < bucket_count; i++)
+      free(buckets[i].data);
+   free(buckets);
+}
+
+/* radix heap on the bits of non-negative floats (monotone keys),
+   bucket b holds keys whose highest bit differing from the last popped key is b - 1 */
+struct m_pf_radix_node
+{
+   unsigned int key;
+   int i;
+};
+
+struct m_pf_radix_heap
+{
+   struct m_pf_radix_node *data[33];
+   int count[33], size[33];
+   unsigned int last;
+   int total;
+};
+
+static unsigned int m__pf_float_key(float f)
+{
+   union { float f; unsigned int u; } v;
+   v.f = f;
+   return v.u;
+}
+
+static int m__pf_radix_bucket(unsigned int key, unsigned int last)
+{
+   unsigned int x = key ^ last;
+   int b = 0;
+   while (x) {
+      x >>= 1;
+      b++;
+   }
+   return b;
+}
+
+static void m__pf_radix_push(struct m_pf_radix_heap *heap, unsigned int key, int i)
+{
+   int b = m__pf_radix_bucket(key, heap->last);
+
+   if (heap->count[b] == heap->size[b]) {
+      heap->size[b] = heap->size[b] > 0 ? heap->size[b] * 2 : 64;
+      heap->data[b] = (struct m_pf_radix_node *)realloc(heap->data[b], heap->size[b] * sizeof(struct m_pf_radix_node));
+   }
+
+   heap->data[b][heap->count[b]].key = key;
+   heap->data[b][heap->count[b]].i = i;
+   heap->count[b]++;
+   heap->total++;
+}
+
+static struct m_pf_radix_node m__pf_radix_pop(struct m_pf_radix_heap *heap)
+{
+   if (heap->count[0] == 0) {
+
+      struct m_pf_radix_node *data;
+      int b = 1, n, j;
+
+      while (heap->count[b] == 0)
+         b++;
+
+      /* new last is the bucket min, redistribute the bucket */
+      data = heap->data[b];
+      n = heap->count[b];
+      heap->last = data[0].key;
+      for (j = 1; j < n; j++)
+         if (data[j].key < heap->last)
+            heap->last = data[j].key;
+
+      heap->count[b] = 0;
+      heap->total -= n;
+      for (j = 0; j < n; j++)
+         m__pf_radix_push(heap, data[j].key, data[j].i);
+   }
+
+   heap->total--;
+   return heap->data[0][--heap->count[0]];
+}
+
+MPFAPI void m_pf_dijkstra_float(float *dist, const float *cost, int w, int h, int x, int y, int connectivity)
+{
+   struct m_pf_radix_heap heap;
+   int dir_count = connectivity == 8 ? 8 : 4;
+   float diag = (float)M_PF_COST_DIAGONAL;
+   float straight = (float)M_PF_COST_STRAIGHT;
+   int size = w * h;
+   int i;
+
+   memset(&heap, 0, sizeof(struct m_pf_radix_heap));
+
+   for (i = 0; i < size; i++)
+      dist[i] = M_PF_FLOAT_MAX;
+
+   if (cost[w * y + x] > 0.0f) {
+      dist[w * y + x] = 0.0f;
+      m__pf_radix_push(&heap, 0, w * y + x);
+   }
+
+   while (heap.total > 0) {
+
+      struct m_pf_radix_node node = m__pf_radix_pop(&heap);
+      int c = node.i;
+      int cx = c % w;
+      int cy = c / w;
+      float d = dist[c];
+      int k;
+
+      if (m__pf_float_key(d) != node.key) /* stale */
+         continue;
+
+      for (k = 0; k < dir_count; k++) {
+
+         int xn = cx + m__pf_dx[k];
+         int yn = cy + m__pf_dy[k];
+         float dn;
+         int n;
+
+         if (xn < 0 || yn < 0 || xn >= w || yn >= h)
+            continue;
+
+         n = w * yn + xn;
+         if (!(cost[n] > 0.0f))
+            continue;
+
+         if (k < 4)
+            dn = d + cost[c] * straight;
+         else {
+            if (!(cost[w * cy + xn] > 0.0f) || !(cost[w * yn + cx] > 0.0f))
+               continue;
+            dn = d + cost[c] * diag;
+         }
+
+         if (dn < dist[n]) {
+            dist[n] = dn;
+            m__pf_radix_push(&heap, m__pf_float_key(dn), n);
+         }
+      }
+   }
+
+   for (i = 0; i < 33; i++)
+      free(heap.data[i]);
+}
+
+static unsigned int m__pf_heuristic(int x0, int y0, int x1, int y1, int heuristic)
+{
+   unsigned int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+   unsigned int dy = y1 > y0 ? y1 - y0 : y0 - y1;
+
+   if (heuristic == M_PF_OCTILE) {
+      unsigned int mn = dx < dy ? dx : dy;
+      return M_PF_COST_STRAIGHT * (dx + dy) + (M_PF_COST_DIAGONAL - 2 * M_PF_COST_STRAIGHT) * mn;
+   }
+
+   return M_PF_COST_STRAIGHT * (dx + dy);
+}
+
+/* new search id (stamps avoid clearing the context) */
+static unsigned int m__pf_new_search(struct m_pf_context *ctx)
+{
+   ctx->search++;
+   if (ctx->search == 0) {
+      memset(ctx->stamp, 0, ctx->w * ctx->h * sizeof(unsigned int));
+      ctx->search = 1;
+   }
+   ctx->heap.count = 0;
+   return ctx->search;
+}
+
+/* write the path from start to goal following dir,
+   a parent can be several cells away in the same direction (jump points):
+   it is the first cell of the current search whose cost matches */
+static int m__pf_trace(struct m_pf_context *ctx, struct m_pf_point *dest, int max_count, int start, int goal)
+{
+   unsigned int *g = ctx->g;
+   unsigned int *stamp = ctx->stamp;
+   unsigned char *dir = ctx->dir;
+   unsigned int search = ctx->search;
+   int w = ctx->w;
+   int pass, count = 0;
+
+   /* count, then write backward */
+   for (pass = 0; pass < 2; pass++) {
+
+      int i = goal;
+      int n = count;
+
+      while (i != start) {
+
+         int d = dir[i];
+         int offset = w * m__pf_dy[d] + m__pf_dx[d];
+         unsigned int cost = d < 4 ? M_PF_COST_STRAIGHT : M_PF_COST_DIAGONAL;
+         unsigned int gi = g[i];
+         int j = i;
+
+         do {
+            if (pass == 0)
+               count++;
+            else if (--n < max_count) {
+               dest[n].x = (unsigned short)(j % w);
+               dest[n].y = (unsigned short)(j / w);
+            }
+            j -= offset;
+            gi -= cost;
+         } while (stamp[j] != search || g[j] != gi);
+
+         i = j;
+      }
+   }
+
+   return count;
+}
+
+/* A* (or Dijkstra over the whole rect if goal < 0) restricted to the rect [rx0, rx1[ x [ry0, ry1[
+   return 1 if goal was reached */
+static int m__pf_astar_rect(struct m_pf_context *ctx, const unsigned int *map, int rx0, int ry0, int rx1, int ry1, int start, int goal, int heuristic)
+{
+   unsigned int *g = ctx->g;
+   unsigned int *stamp = ctx->stamp;
+   unsigned char *dir = ctx->dir;
+   unsigned int search;
+   int w = ctx->w;
+   int dir_count = heuristic == M_PF_OCTILE ? 8 : 4;
+   int x1 = goal < 0 ? 0 : goal % w;
+   int y1 = goal < 0 ? 0 : goal / w;
+
+   search = m__pf_new_search(ctx);
+
+   stamp[start] = search;
+   g[start] = 0;
+   m__pf_heap_push(&ctx->heap, goal < 0 ? 0 : m__pf_heuristic(start % w, start / w, x1, y1, heuristic), 0, start);
+
+   while (ctx->heap.count > 0) {
+
+      struct m_pf_heap_node node = m__pf_heap_pop(&ctx->heap);
+      int x, y, d;
+
+      if (node.g != g[node.i]) /* stale */
+         continue;
+      if (node.i == goal)
+         return 1;
+
+      x = node.i % w;
+      y = node.i / w;
+
+      for (d = 0; d < dir_count; d++) {
+
+         int xn = x + m__pf_dx[d];
+         int yn = y + m__pf_dy[d];
+         unsigned int gn;
+         int in;
+
+         if (xn < rx0 || yn < ry0 || xn >= rx1 || yn >= ry1)
+            continue;
+
+         in = w * yn + xn;
+         if (map[in] == UINT_MAX)
+            continue;
+
+         if (d < 4)
+            gn = node.g + M_PF_COST_STRAIGHT;
+         else {
+            /* no corner cutting */
+            if (map[w * y + xn] == UINT_MAX || map[w * yn + x] == UINT_MAX)
+               continue;
+            gn = node.g + M_PF_COST_DIAGONAL;
+         }
+
+         if (stamp[in] != search || gn < g[in]) {
+            stamp[in] = search;
+            g[in] = gn;
+            dir[in] = (unsigned char)d;
+            m__pf_heap_push(&ctx->heap, goal < 0 ? gn : gn + m__pf_heuristic(xn, yn, x1, y1, heuristic), gn, in);
+         }
+      }
+   }
+
+   return 0;
+}
+
+MPFAPI int m_pf_astar(struct m_pf_context *ctx, struct m_pf_point *dest, int max_count, const unsigned int *map, int x0, int y0, int x1, int y1, int heuristic)
+{
+   int start = ctx->w * y0 + x0;
+   int goal = ctx->w * y1 + x1;
+
+   if (map[start] == UINT_MAX || map[goal] == UINT_MAX || start == goal)
+      return 0;
+
+   if (!m__pf_astar_rect(ctx, map, 0, 0, ctx->w, ctx->h, start, goal, heuristic))
+      return 0;
+
+   return m__pf_trace(ctx, dest, max_count, start, goal);
+}
+
+#define M_PF_WALKABLE(x2, y2) ((x2) >= 0 && (y2) >= 0 && (x2) < w && (y2) < h && map[w * (y2) + (x2)] != UINT_MAX)
+
+/* jump from (x, y) in direction (dx, dy), return the jump point index or -1 */
+static int m__pf_jump(const unsigned int *map, int w, int h, int x, int y, int dx, int dy, int goal)
+{
+   while (1) {
+
+      x += dx;
+      y += dy;
+
+      if (!M_PF_WALKABLE(x, y))
+         return -1;
+      if (w * y + x == goal)
+         return goal;
+
+      if (dx != 0 && dy != 0) {
+         if (m__pf_jump(map, w, h, x, y, dx, 0, goal) >= 0 ||
+             m__pf_jump(map, w, h, x, y, 0, dy, goal) >= 0)
+            return w * y + x;
+         if (!M_PF_WALKABLE(x + dx, y) || !M_PF_WALKABLE(x, y + dy))
+            return -1;
+      }
+      else if (dx != 0) {
+         if ((M_PF_WALKABLE(x, y - 1) && !M_PF_WALKABLE(x - dx, y - 1)) ||
+             (M_PF_WALKABLE(x, y + 1) && !M_PF_WALKABLE(x - dx, y + 1)))
+            return w * y + x;
+      }
+      else {
+         if ((M_PF_WALKABLE(x - 1, y) && !M_PF_WALKABLE(x - 1, y - dy)) ||
+             (M_PF_WALKABLE(x + 1, y) && !M_PF_WALKABLE(x + 1, y - dy)))
+            return w * y + x;
+      }
+   }
+}
+
+static int m__pf_dir(int dx, int dy)
+{
+   int d;
+   for (d = 0; d < 8; d++)
+      if (m__pf_dx[d] == dx && m__pf_dy[d] == dy)
+         return d;
+   return -1;
+}
+
+MPFAPI int m_pf_jps(struct m_pf_context *ctx, struct m_pf_point *dest, int max_count, const unsigned int *map, int x0, int y0, int x1, int y1)
+{
+   unsigned int *g = ctx->g;
+   unsigned int *stamp = ctx->stamp;
+   unsigned char *dir = ctx->dir;
+   unsigned int search;
+   int w = ctx->w;
+   int h = ctx->h;
+   int start = w * y0 + x0;
+   int goal = w * y1 + x1;
+
+   if (map[start] == UINT_MAX || map[goal] == UINT_MAX || start == goal)
+      return 0;
+
+   search = m__pf_new_search(ctx);
+
+   stamp[start] = search;
+   g[start] = 0;
+   m__pf_heap_push(&ctx->heap, m__pf_heuristic(x0, y0, x1, y1, M_PF_OCTILE), 0, start);
+
+   while (ctx->heap.count > 0) {
+
+      struct m_pf_heap_node node = m__pf_heap_pop(&ctx->heap);
+      int ndx[8], ndy[8];
+      int x, y, k, n = 0;
+
+      if (node.g != g[node.i]) /* stale */
+         continue;
+      if (node.i == goal)
+         break;
+
+      x = node.i % w;
+      y = node.i / w;
+
+      /* pruned neighbors */
+      if (node.i == start) {
+         for (k = 0; k < 8; k++) {
+            int dx = m__pf_dx[k], dy = m__pf_dy[k];
+            if (k >= 4 && (!M_PF_WALKABLE(x + dx, y) || !M_PF_WALKABLE(x, y + dy)))
+               continue;
+            ndx[n] = dx; ndy[n] = dy; n++;
+         }
+      }
+      else {
+         int dx = m__pf_dx[dir[node.i]];
+         int dy = m__pf_dy[dir[node.i]];
+
+         if (dx != 0 && dy != 0) {
+            int walk_x = M_PF_WALKABLE(x + dx, y);
+            int walk_y = M_PF_WALKABLE(x, y + dy);
+            if (walk_y) { ndx[n] = 0; ndy[n] = dy; n++; }
+            if (walk_x) { ndx[n] = dx; ndy[n] = 0; n++; }
+            if (walk_x && walk_y) { ndx[n] = dx; ndy[n] = dy; n++; }
+         }
+         else if (dx != 0) {
+            int walk_n = M_PF_WALKABLE(x + dx, y);
+            int walk_t = M_PF_WALKABLE(x, y + 1);
+            int walk_b = M_PF_WALKABLE(x, y - 1);
+            if (walk_n) {
+               ndx[n] = dx; ndy[n] = 0; n++;
+               if (walk_t) { ndx[n] = dx; ndy[n] = 1; n++; }
+               if (walk_b) { ndx[n] = dx; ndy[n] = -1; n++; }
+            }
+            if (walk_t) { ndx[n] = 0; ndy[n] = 1; n++; }
+            if (walk_b) { ndx[n] = 0; ndy[n] = -1; n++; }
+         }
+         else {
+            int walk_n = M_PF_WALKABLE(x, y + dy);
+            int walk_r = M_PF_WALKABLE(x + 1, y);
+            int walk_l = M_PF_WALKABLE(x - 1, y);
+            if (walk_n) {
+               ndx[n] = 0; ndy[n] = dy; n++;
+               if (walk_r) { ndx[n] = 1; ndy[n] = dy; n++; }
+               if (walk_l) { ndx[n] = -1; ndy[n] = dy; n++; }
+            }
+            if (walk_r) { ndx[n] = 1; ndy[n] = 0; n++; }
+            if (walk_l) { ndx[n] = -1; ndy[n] = 0; n++; }
+         }
+      }
+
+      /* jump and relax */
+      for (k = 0; k < n; k++) {
+
+         int jp = m__pf_jump(map, w, h, x, y, ndx[k], ndy[k], goal);
+         unsigned int gn;
+         int jx, jy, steps;
+
+         if (jp < 0)
+            continue;
+
+         jx = jp % w;
+         jy = jp / w;
+         steps = jx != x ? (jx > x ? jx - x : x - jx) : (jy > y ? jy - y : y - jy);
+         gn = node.g + steps * ((ndx[k] != 0 && ndy[k] != 0) ? M_PF_COST_DIAGONAL : M_PF_COST_STRAIGHT);
+
+         if (stamp[jp] != search || gn < g[jp]) {
+            stamp[jp] = search;
+            g[jp] = gn;
+            dir[jp] = (unsigned char)m__pf_dir(ndx[k], ndy[k]);
+            m__pf_heap_push(&ctx->heap, gn + m__pf_heuristic(jx, jy, x1, y1, M_PF_OCTILE), gn, jp);
+         }
+      }
+   }
+
+   if (stamp[goal] != search)
+      return 0;
+
+   return m__pf_trace(ctx, dest, max_count, start, goal);
+}
+
+static void m__pf_hpa_add_node(struct m_pf_hpa_cluster *cluster, int cell, int side)
+{
+   if (cluster->count == cluster->size) {
+      int size = cluster->size > 0 ? cluster->size * 2 : 8;
+      cluster->cells = (int *)realloc(cluster->cells, size * sizeof(int));
+      cluster->sides = (unsigned char *)realloc(cluster->sides, size);
+      cluster->g = (unsigned int *)realloc(cluster->g, size * sizeof(unsigned int));
+      cluster->stamp = (unsigned int *)realloc(cluster->stamp, size * sizeof(unsigned int));
+      cluster->parent = (int *)realloc(cluster->parent, size * sizeof(int));
+      cluster->size = size;
+   }
+
+   cluster->cells[cluster->count] = cell;
+   cluster->sides[cluster->count] = (unsigned char)side;
+   cluster->stamp[cluster->count] = 0;
+   cluster->count++;
+}
+
+/* entrances along one border: maximal runs of cells walkable on both sides,
+   one transition in the middle of short runs, two at the ends of long runs */
+static void m__pf_hpa_add_side(struct m_pf_hpa_cluster *cluster, const unsigned int *map, int side, int cell, int step, int pair, int length)
+{
+   int i, run = 0;
+
+   for (i = 0; i <= length; i++) {
+
+      int c = cell + i * step;
+
+      if (i < length && map[c] != UINT_MAX && map[c + pair] != UINT_MAX) {
+         run++;
+         continue;
+      }
+
+      if (run > 0) {
+         int first = c - run * step;
+         if (run < 6)
+            m__pf_hpa_add_node(cluster, first + ((run - 1) / 2) * step, side);
+         else {
+            m__pf_hpa_add_node(cluster, first, side);
+            m__pf_hpa_add_node(cluster, c - step, side);
+         }
+         run = 0;
+      }
+   }
+}
+
+/* intra-cluster search scratch: the cluster rect copied with a one cell wall border,
+   row stride M_PF_HPA_STRIDE, mark: stamp of the cells holding a node still to be reached */
+#define M_PF_HPA_STRIDE (M_PF_HPA_MAX_CLUSTER + 2)
+
+struct m__pf_hpa_scratch
+{
+   struct m_pf_bucket buckets[M_PF_COST_DIAGONAL + 1];
+   unsigned int dist[M_PF_HPA_STRIDE * M_PF_HPA_STRIDE];
+   int mark[M_PF_HPA_STRIDE * M_PF_HPA_STRIDE];
+   unsigned char walls[M_PF_HPA_STRIDE * M_PF_HPA_STRIDE];
+};
+
+/* dijkstra from the local cell start until the remaining cells marked with stamp are settled */
+static void m__pf_hpa_flood(struct m__pf_hpa_scratch *scratch, int start, int stamp, int remaining)
+{
+   static const int offsets[8] = {
+      -M_PF_HPA_STRIDE, -1, 1, M_PF_HPA_STRIDE,
+      -M_PF_HPA_STRIDE - 1, -M_PF_HPA_STRIDE + 1, M_PF_HPA_STRIDE - 1, M_PF_HPA_STRIDE + 1
+   };
+   struct m_pf_bucket *buckets = scratch->buckets;
+   const unsigned char *walls = scratch->walls;
+   unsigned int *dist = scratch->dist;
+   int bucket_count = M_PF_COST_DIAGONAL + 1;
+   int pending = 1;
+   unsigned int d;
+   int i;
+
+   for (i = 0; i < M_PF_HPA_STRIDE * M_PF_HPA_STRIDE; i++)
+      dist[i] = UINT_MAX;
+
+   dist[start] = 0;
+   buckets[0].data[0] = start;
+   buckets[0].count = 1;
+
+   for (d = 0; pending > 0 && remaining > 0; d++) {
+
+      struct m_pf_bucket *bucket = &buckets[d % bucket_count];
+
+      for (i = 0; i < bucket->count && remaining > 0; i++) {
+
+         int c = bucket->data[i];
+         int k;
+
+         pending--;
+         if (dist[c] != d) /* stale */
+            continue;
+         if (scratch->mark[c] == stamp)
+            remaining--;
+
+         for (k = 0; k < 8; k++) {
+
+            int n = c + offsets[k];
+            unsigned int dn;
+            struct m_pf_bucket *bn;
+
+            if (walls[n])
+               continue;
+
+            if (k < 4)
+               dn = d + M_PF_COST_STRAIGHT;
+            else {
+               /* no corner cutting */
+               if (walls[c + m__pf_dx[k]] || walls[c + M_PF_HPA_STRIDE * m__pf_dy[k]])
+                  continue;
+               dn = d + M_PF_COST_DIAGONAL;
+            }
+
+            if (dn >= dist[n])
+               continue;
+
+            dist[n] = dn;
+            bn = &buckets[dn % bucket_count];
+            if (bn->count == bn->size) {
+               bn->size *= 2;
+               bn->data = (int *)realloc(bn->data, bn->size * sizeof(int));
+            }
+            bn->data[bn->count++] = n;
+            pending++;
+         }
+      }
+
+      bucket->count = 0;
+   }
+
+   for (i = 0; i < bucket_count; i++)
+      buckets[i].count = 0;
+}
+
+static void m__pf_hpa_build_cluster(struct m_pf_hpa *hpa, struct m__pf_hpa_scratch *scratch, int k)
+{
+   struct m_pf_hpa_cluster *cluster = &hpa->clusters[k];
+   const unsigned int *map = hpa->map;
+   int w = hpa->w;
+   int cx = k % hpa->cw;
+   int cy = k / hpa->cw;
+   int x0 = cx * hpa->cluster_size;
+   int y0 = cy * hpa->cluster_size;
+   int x1 = M_PF_MIN(x0 + hpa->cluster_size, hpa->w);
+   int y1 = M_PF_MIN(y0 + hpa->cluster_size, hpa->h);
+   int n, a, b, x, y;
+
+   /* nodes */
+   cluster->count = 0;
+   if (cy > 0)
+      m__pf_hpa_add_side(cluster, map, 0, w * y0 + x0, 1, -w, x1 - x0);
+   if (cx > 0)
+      m__pf_hpa_add_side(cluster, map, 1, w * y0 + x0, w, -1, y1 - y0);
+   if (cx < hpa->cw - 1)
+      m__pf_hpa_add_side(cluster, map, 2, w * y0 + x1 - 1, w, 1, y1 - y0);
+   if (cy < hpa->ch - 1)
+      m__pf_hpa_add_side(cluster, map, 3, w * (y1 - 1) + x0, 1, w, x1 - x0);
+
+   /* intra-cluster costs: one search per node, to the nodes after it */
+   n = cluster->count;
+   free(cluster->costs);
+   cluster->costs = n > 0 ? (unsigned int *)malloc(n * n * sizeof(unsigned int)) : NULL;
+
+   /* local cell of (x, y): M_PF_HPA_STRIDE * (y - y0 + 1) + x - x0 + 1 */
+#define M_PF_HPA_LOCAL(c) (M_PF_HPA_STRIDE * ((c) / w - y0 + 1) + (c) % w - x0 + 1)
+
+   memset(scratch->walls, 1, sizeof(scratch->walls));
+   for (y = y0; y < y1; y++)
+      for (x = x0; x < x1; x++)
+         scratch->walls[M_PF_HPA_STRIDE * (y - y0 + 1) + x - x0 + 1] = map[w * y + x] == UINT_MAX;
+
+   for (a = 0; a < M_PF_HPA_STRIDE * M_PF_HPA_STRIDE; a++)
+      scratch->mark[a] = -1;
+
+   for (a = 0; a < n; a++) {
+
+      int remaining = 0;
+
+      cluster->costs[a * n + a] = 0;
+      if (a == n - 1)
+         break;
+
+      for (b = a + 1; b < n; b++) {
+         int *mark = &scratch->mark[M_PF_HPA_LOCAL(cluster->cells[b])];
+         if (*mark != a) {
+            *mark = a;
+            remaining++;
+         }
+      }
+
+      m__pf_hpa_flood(scratch, M_PF_HPA_LOCAL(cluster->cells[a]), a, remaining);
+
+      for (b = a + 1; b < n; b++) {
+         unsigned int cost = scratch->dist[M_PF_HPA_LOCAL(cluster->cells[b])];
+         cluster->costs[a * n + b] = cost;
+         cluster->costs[b * n + a] = cost;
+      }
+   }
+
+#undef M_PF_HPA_LOCAL
+}
+
+static void m__pf_hpa_scratch_create(struct m__pf_hpa_scratch *scratch)
+{
+   int i;
+   for (i = 0; i <= M_PF_COST_DIAGONAL; i++) {
+      scratch->buckets[i].size = 64;
+      scratch->buckets[i].count = 0;
+      scratch->buckets[i].data = (int *)malloc(64 * sizeof(int));
+   }
+}
+
+static void m__pf_hpa_scratch_destroy(struct m__pf_hpa_scratch *scratch)
+{
+   int i;
+   for (i = 0; i <= M_PF_COST_DIAGONAL; i++)
+      free(scratch->buckets[i].data);
+}
+
+MPFAPI void m_pf_hpa_create(struct m_pf_hpa *hpa, const unsigned int *map, int w, int h, int cluster_size)
+{
+   int k, count;
+
+   if (cluster_size < M_PF_HPA_MIN_CLUSTER)
+      cluster_size = M_PF_HPA_MIN_CLUSTER;
+   else if (cluster_size > M_PF_HPA_MAX_CLUSTER)
+      cluster_size = M_PF_HPA_MAX_CLUSTER;
+
+   hpa->map = map;
+   hpa->w = w;
+   hpa->h = h;
+   hpa->cluster_size = cluster_size;
+   hpa->cw = (w + cluster_size - 1) / cluster_size;
+   hpa->ch = (h + cluster_size - 1) / cluster_size;
+   hpa->search = 0;
+   hpa->path = NULL;
+   hpa->path_size = 0;
+   hpa->heap.data = NULL;
+   hpa->heap.count = 0;
+   hpa->heap.size = 0;
+
+   count = hpa->cw * hpa->ch;
+   hpa->clusters = (struct m_pf_hpa_cluster *)calloc(count, sizeof(struct m_pf_hpa_cluster));
+   m_pf_context_create(&hpa->ctx, w, h);
+
+   /* clusters are independent */
+   #pragma omp parallel
+   {
+      struct m__pf_hpa_scratch scratch;
+      m__pf_hpa_scratch_create(&scratch);
+
+      #pragma omp for schedule(dynamic, 8)
+      for (k = 0; k < count; k++)
+         m__pf_hpa_build_cluster(hpa, &scratch, k);
+
+      m__pf_hpa_scratch_destroy(&scratch);
+   }
+}
+
+MPFAPI void m_pf_hpa_destroy(struct m_pf_hpa *hpa)
+{
+   int k, count = hpa->cw * hpa->ch;
+
+   for (k = 0; k < count; k++) {
+      struct m_pf_hpa_cluster *cluster = &hpa->clusters[k];
+      free(cluster->parent);
+      free(cluster->stamp);
+      free(cluster->g);
+      free(cluster->costs);
+      free(cluster->sides);
+      free(cluster->cells);
+   }
+
+   m_pf_context_destroy(&hpa->ctx);
+   free(hpa->heap.data);
+   free(hpa->path);
+   free(hpa->clusters);
+}
+
+MPFAPI void m_pf_hpa_update(struct m_pf_hpa *hpa, int x, int y, int w, int h)
+{
+   /* cells on a cluster border also change the entrances of the neighbor cluster */
+   int cx0 = M_PF_MAX(x - 1, 0) / hpa->cluster_size;
+   int cy0 = M_PF_MAX(y - 1, 0) / hpa->cluster_size;
+   int cx1 = M_PF_MIN(x + w, hpa->w - 1) / hpa->cluster_size;
+   int cy1 = M_PF_MIN(y + h, hpa->h - 1) / hpa->cluster_size;
+   struct m__pf_hpa_scratch scratch;
+   int cx, cy;
+
+   m__pf_hpa_scratch_create(&scratch);
+   for (cy = cy0; cy <= cy1; cy++)
+      for (cx = cx0; cx <= cx1; cx++)
+         m__pf_hpa_build_cluster(hpa, &scratch, cy * hpa->cw + cx);
+   m__pf_hpa_scratch_destroy(&scratch);
+}
+
+/* abstract node id: cluster * M_PF_HPA_MAX_NODES + node */
+static void m__pf_hpa_relax(struct m_pf_hpa *hpa, int k, int a, unsigned int g, int parent, int goal)
+{
+   struct m_pf_hpa_cluster *cluster = &hpa->clusters[k];
+   int w = hpa->w;
+
+   if (cluster->stamp[a] != hpa->search || g < cluster->g[a]) {
+      int c = cluster->cells[a];
+      cluster->stamp[a] = hpa->search;
+      cluster->g[a] = g;
+      cluster->parent[a] = parent;
+      m__pf_heap_push(&hpa->heap, g + m__pf_heuristic(c % w, c / w, goal % w, goal / w, M_PF_OCTILE), g, k * M_PF_HPA_MAX_NODES + a);
+   }
+}
+
+/* local path from cell a to cell b inside cluster k, appended to dest */
+static int m__pf_hpa_refine(struct m_pf_hpa *hpa, struct m_pf_point *dest, int max_count, int k, int a, int b)
+{
+   int cs = hpa->cluster_size;
+   int x0 = (k % hpa->cw) * cs;
+   int y0 = (k / hpa->cw) * cs;
+
+   if (a == b)
+      return 0;
+
+   if (!m__pf_astar_rect(&hpa->ctx, hpa->map, x0, y0, M_PF_MIN(x0 + cs, hpa->w), M_PF_MIN(y0 + cs, hpa->h), a, b, M_PF_OCTILE))
+      return 0;
+
+   return m__pf_trace(&hpa->ctx, dest, max_count, a, b);
+}
+
+MPFAPI int m_pf_hpa_find(struct m_pf_hpa *hpa, struct m_pf_point *dest, int max_count, int x0, int y0, int x1, int y1)
+{
+   unsigned int goal_cost[M_PF_HPA_MAX_NODES];
+   const unsigned int *map = hpa->map;
+   struct m_pf_hpa_cluster *scluster, *gcluster;
+   unsigned int goal_g = UINT_MAX;
+   int goal_parent = -1;
+   int w = hpa->w;
+   int cs = hpa->cluster_size;
+   int start = w * y0 + x0;
+   int goal = w * y1 + x1;
+   int sk = (y0 / cs) * hpa->cw + x0 / cs;
+   int gk = (y1 / cs) * hpa->cw + x1 / cs;
+   int i, n, count, prev, prev_k;
+
+   if (map[start] == UINT_MAX || map[goal] == UINT_MAX || start == goal)
+      return 0;
+
+   /* same cluster */
+   if (sk == gk) {
+      count = m__pf_hpa_refine(hpa, dest, max_count, sk, start, goal);
+      if (count > 0)
+         return count;
+   }
+
+   scluster = &hpa->clusters[sk];
+   gcluster = &hpa->clusters[gk];
+
+   /* goal to its cluster nodes */
+   m__pf_astar_rect(&hpa->ctx, map, (gk % hpa->cw) * cs, (gk / hpa->cw) * cs,
+                    M_PF_MIN((gk % hpa->cw + 1) * cs, w), M_PF_MIN((gk / hpa->cw + 1) * cs, hpa->h), goal, -1, M_PF_OCTILE);
+   for (i = 0; i < gcluster->count; i++) {
+      int c = gcluster->cells[i];
+      goal_cost[i] = hpa->ctx.stamp[c] == hpa->ctx.search ? hpa->ctx.g[c] : UINT_MAX;
+   }
+
+   /* new abstract search */
+   hpa->search++;
+   if (hpa->search == 0) {
+      int k;
+      for (k = 0; k < hpa->cw * hpa->ch; k++)
+         memset(hpa->clusters[k].stamp, 0, hpa->clusters[k].count * sizeof(unsigned int));
+      hpa->search = 1;
+   }
+   hpa->heap.count = 0;
+
+   /* start to its cluster nodes */
+   m__pf_astar_rect(&hpa->ctx, map, (sk % hpa->cw) * cs, (sk / hpa->cw) * cs,
+                    M_PF_MIN((sk % hpa->cw + 1) * cs, w), M_PF_MIN((sk / hpa->cw + 1) * cs, hpa->h), start, -1, M_PF_OCTILE);
+   for (i = 0; i < scluster->count; i++) {
+      int c = scluster->cells[i];
+      if (hpa->ctx.stamp[c] == hpa->ctx.search)
+         m__pf_hpa_relax(hpa, sk, i, hpa->ctx.g[c], -1, goal);
+   }
+
+   /* abstract A* (the goal is node -1) */
+   while (hpa->heap.count > 0) {
+
+      struct m_pf_heap_node node = m__pf_heap_pop(&hpa->heap);
+      struct m_pf_hpa_cluster *cluster;
+      int k, a, b, side, nk, partner;
+
+      if (node.i < 0) {
+         if (node.g == goal_g)
+            break;
+         continue;
+      }
+
+      k = node.i / M_PF_HPA_MAX_NODES;
+      a = node.i % M_PF_HPA_MAX_NODES;
+      cluster = &hpa->clusters[k];
+      if (node.g != cluster->g[a]) /* stale */
+         continue;
+
+      /* goal */
+      if (k == gk && goal_cost[a] != UINT_MAX && node.g + goal_cost[a] < goal_g) {
+         goal_g = node.g + goal_cost[a];
+         goal_parent = node.i;
+         m__pf_heap_push(&hpa->heap, goal_g, goal_g, -1);
+      }
+
+      /* intra-cluster edges */
+      n = cluster->count;
+      for (b = 0; b < n; b++) {
+         unsigned int cost = cluster->costs[a * n + b];
+         if (b != a && cost != UINT_MAX)
+            m__pf_hpa_relax(hpa, k, b, node.g + cost, node.i, goal);
+      }
+
+      /* inter-cluster edge */
+      side = cluster->sides[a];
+      nk = k + m__pf_dx[side] + m__pf_dy[side] * hpa->cw;
+      partner = cluster->cells[a] + m__pf_dx[side] + m__pf_dy[side] * w;
+      for (b = 0; b < hpa->clusters[nk].count; b++) {
+         if (hpa->clusters[nk].cells[b] == partner && hpa->clusters[nk].sides[b] == 3 - side) {
+            m__pf_hpa_relax(hpa, nk, b, node.g + M_PF_COST_STRAIGHT, node.i, goal);
+            break;
+         }
+      }
+   }
+
+   if (goal_parent < 0)
+      return 0;
+
+   /* abstract path (backward) */
+   n = 0;
+   for (i = goal_parent; i >= 0; i = hpa->clusters[i / M_PF_HPA_MAX_NODES].parent[i % M_PF_HPA_MAX_NODES]) {
+      if (n == hpa->path_size) {
+         hpa->path_size = hpa->path_size > 0 ? hpa->path_size * 2 : 64;
+         hpa->path = (int *)realloc(hpa->path, hpa->path_size * sizeof(int));
+      }
+      hpa->path[n++] = i;
+   }
+
+   /* refine */
+   count = 0;
+   prev = start;
+   prev_k = sk;
+   for (i = n - 1; i >= 0; i--) {
+
+      int k = hpa->path[i] / M_PF_HPA_MAX_NODES;
+      int c = hpa->clusters[k].cells[hpa->path[i] % M_PF_HPA_MAX_NODES];
+
+      if (k == prev_k)
+         count += m__pf_hpa_refine(hpa, dest + count, max_count - count, k, prev, c);
+      else {
+         if (count < max_count) {
+            dest[count].x = (unsigned short)(c % w);
+            dest[count].y = (unsigned short)(c / w);
+         }
+         count++;
+      }
+
+      prev = c;
+      prev_k = k;
+   }
+
+   count += m__pf_hpa_refine(hpa, dest + count, max_count - count, gk, prev, goal);
+   return count;
+}
+
+/* cost of the step from u (closer to the goal) to v = u - (dx[k], dy[k]) */
+static unsigned int m__pf_lpa_edge(struct m_pf_lpa *lpa, int vx, int vy, int k)
+{
+   const unsigned char *cost = lpa->cost;
+   int w = lpa->w;
+   int ux = vx + m__pf_dx[k];
+   int uy = vy + m__pf_dy[k];
+   unsigned int c;
+
+   if (ux < 0 || uy < 0 || ux >= w || uy >= lpa->h)
+      return UINT_MAX;
+
+   c = cost[w * uy + ux];
+   if (c == 0)
+      return UINT_MAX;
+
+   if (k < 4)
+      return c * M_PF_COST_STRAIGHT;
+
+   if (cost[w * vy + ux] == 0 || cost[w * uy + vx] == 0)
+      return UINT_MAX;
+   return c * M_PF_COST_DIAGONAL;
+}
+
+static void m__pf_lpa_update_cell(struct m_pf_lpa *lpa, int x, int y)
+{
+   int w = lpa->w;
+   int v = w * y + x;
+   unsigned int key;
+
+   if (x < 0 || y < 0 || x >= w || y >= lpa->h)
+      return;
+
+   if (v != lpa->goal || lpa->cost[v] == 0) {
+
+      unsigned int rhs = UINT_MAX;
+
+      if (lpa->cost[v] != 0) {
+
+         int dir_count = lpa->connectivity == 8 ? 8 : 4;
+         int k;
+
+         for (k = 0; k < dir_count; k++) {
+
+            unsigned int c = m__pf_lpa_edge(lpa, x, y, k);
+            unsigned int gu;
+
+            if (c == UINT_MAX)
+               continue;
+
+            gu = lpa->g[w * (y + m__pf_dy[k]) + x + m__pf_dx[k]];
+            if (gu != UINT_MAX && gu + c < rhs)
+               rhs = gu + c;
+         }
+      }
+
+      lpa->rhs[v] = rhs;
+   }
+   else {
+      lpa->rhs[v] = 0;
+   }
+
+   if (lpa->g[v] != lpa->rhs[v]) {
+      key = M_PF_MIN(lpa->g[v], lpa->rhs[v]);
+      m__pf_heap_push(&lpa->heap, key, 0, v);
+   }
+}
+
+static void m__pf_lpa_update_neighbors(struct m_pf_lpa *lpa, int x, int y)
+{
+   int dir_count = lpa->connectivity == 8 ? 8 : 4;
+   int k;
+
+   for (k = 0; k < dir_count; k++)
+      m__pf_lpa_update_cell(lpa, x + m__pf_dx[k], y + m__pf_dy[k]);
+}
+
+MPFAPI void m_pf_lpa_create(struct m_pf_lpa *lpa, const unsigned char *cost, int w, int h, int x, int y, int connectivity)
+{
+   int size = w * h;
+   int i;
+
+   memset(lpa, 0, sizeof(struct m_pf_lpa));
+   lpa->cost = cost;
+   lpa->w = w;
+   lpa->h = h;
+   lpa->goal = w * y + x;
+   lpa->connectivity = connectivity;
+   lpa->g = (unsigned int *)malloc(size * sizeof(unsigned int));
+   lpa->rhs = (unsigned int *)malloc(size * sizeof(unsigned int));
+
+   for (i = 0; i < size; i++) {
+      lpa->g[i] = UINT_MAX;
+      lpa->rhs[i] = UINT_MAX;
+   }
+
+   m__pf_lpa_update_cell(lpa, x, y);
+   m_pf_lpa_compute(lpa);
+}
+
+MPFAPI void m_pf_lpa_destroy(struct m_pf_lpa *lpa)
+{
+   free(lpa->heap.data);
+   free(lpa->rhs);
+   free(lpa->g);
+}
+
+MPFAPI void m_pf_lpa_notify(struct m_pf_lpa *lpa, int x, int y)
+{
+   /* the cell is the end, the start or the corner of the steps around it */
+   m__pf_lpa_update_cell(lpa, x, y);
+   m__pf_lpa_update_neighbors(lpa, x, y);
+}
+
+MPFAPI int m_pf_lpa_compute(struct m_pf_lpa *lpa)
+{
+   int w = lpa->w;
+   int expanded = 0;
+
+   while (lpa->heap.count > 0) {
+
+      struct m_pf_heap_node node = m__pf_heap_pop(&lpa->heap);
+      int v = node.i;
+      int x = v % w;
+      int y = v / w;
+
+      /* consistent or stale */
+      if (lpa->g[v] == lpa->rhs[v] || node.f != M_PF_MIN(lpa->g[v], lpa->rhs[v]))
+         continue;
+
+      if (lpa->g[v] > lpa->rhs[v]) {
+         lpa->g[v] = lpa->rhs[v];
+      }
+      else {
+         lpa->g[v] = UINT_MAX;
+         m__pf_lpa_update_cell(lpa, x, y);
+      }
+
+      m__pf_lpa_update_neighbors(lpa, x, y);
+      expanded++;
+   }
+
+   return expanded;
+}
+
+MPFAPI int m_pf_lpa_path(struct m_pf_lpa *lpa, struct m_pf_point *dest, int max_count, int x, int y)
+{
+   int dir_count = lpa->connectivity == 8 ? 8 : 4;
+   int w = lpa->w;
+   int v = w * y + x;
+   int count = 0;
+
+   if (lpa->g[v] == UINT_MAX)
+      return 0;
+
+   while (v != lpa->goal) {
+
+      unsigned int min = UINT_MAX;
+      int next = -1;
+      int k;
+
+      for (k = 0; k < dir_count; k++) {
+
+         unsigned int c = m__pf_lpa_edge(lpa, x, y, k);
+         unsigned int gu;
+
+         if (c == UINT_MAX)
+            continue;
+
+         gu = lpa->g[w * (y + m__pf_dy[k]) + x + m__pf_dx[k]];
+         if (gu != UINT_MAX && gu + c < min) {
+            min = gu + c;
+            next = k;
+         }
+      }
+
+      if (next < 0)
+         return 0;
+
+      x += m__pf_dx[next];
+      y += m__pf_dy[next];
+      v = w * y + x;
+
+      if (count < max_count) {
+         dest[count].x = (unsigned short)x;
+         dest[count].y = (unsigned short)y;
+      }
+      count++;
+   }
+
+   return count;
+}
+
+#undef M_PF_MAX
+#undef M_PF_MIN
+#undef M_PF_WALKABLE
 #undef M_PF_PUSH_PIXEL
 
 #endif /* M_PF_IMPLEMENTATION */
\ No newline at end of file
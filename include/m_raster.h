@@ -27,7 +27,14 @@
 /*
    Simple rasterization:
    - triangle with perspective correct interpolation
-   - basic line, circle and polygon
+   - sub-pixel precision and top-left fill rule (watertight meshes)
+   - tiled triangle mesh (multi-threaded with OpenMP)
+   - homogeneous near plane clipping and guard band
+   - depth buffer with hierarchical z
+   - any number of attributes, visibility buffer
+   - basic line, circle and polygon (clipped, span filled)
+   - anti-aliased line, circle and polygon (exact area coverage)
+   - float or ubyte RGBA output (overwrite, alpha blending, additive)
    
    to create the implementation,
    #define M_RASTER_IMPLEMENTATION
@@ -50,15 +57,126 @@ extern "C" {
 /* inverse bilinear interpolation */
 MRAPI void m_raster_inv_bilerp(float *dest, float x, float y, const float *v0, const float *v1, const float *v2, const float *v3);
 
-/* triangle with 4 components attributes (float 4 vertices and attributes) */
+/* triangle with 4 components attributes (float 4 vertices and attributes)
+   vertices are snapped to 1 / M_RASTER_SUBPIXEL pixel and pixels are sampled at integer
+   coordinates with a top-left fill rule: triangles sharing an edge never overlap nor leave gaps
+   (screen coordinates must stay within +/- 2^18 pixels) */
+#define M_RASTER_SUBPIXEL 16
 MRAPI void m_raster_triangle_bbox_att4(float *dest, int width, int height, int minx, int miny, int maxx, int maxy, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2);
 MRAPI void m_raster_triangle_att4(float *dest, int width, int height, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2);
 
-/* basic 2d rasterization (float 2 points) */
+/* depth buffer: stores the interpolated v[3] (1 / w, greater is closer, 0 = far)
+   and the farthest and nearest depth of each M_RASTER_BLOCK block (hierarchical z),
+   hidden blocks are rejected before any per-pixel work */
+#define M_RASTER_BLOCK 8
+
+struct m_raster_depth
+{
+   float *data;
+   float *blocks; /* (min, max) per block */
+   int width, height;
+   int bw, bh;
+};
+
+MRAPI void m_raster_depth_create(struct m_raster_depth *depth, int width, int height);
+MRAPI void m_raster_depth_destroy(struct m_raster_depth *depth);
+MRAPI void m_raster_depth_clear(struct m_raster_depth *depth);
+
+/* depth tested triangle with 4 components attributes */
+MRAPI void m_raster_triangle_bbox_depth_att4(float *dest, struct m_raster_depth *depth, int minx, int miny, int maxx, int maxy, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2);
+MRAPI void m_raster_triangle_depth_att4(float *dest, struct m_raster_depth *depth, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2);
+
+/* triangle with comp components attributes (1 to M_RASTER_MAX_ATT), depth can be NULL,
+   width is the row size of dest, pixels outside the depth buffer are not drawn */
+#define M_RASTER_MAX_ATT 16
+MRAPI void m_raster_triangle_bbox_attn(float *dest, int comp, struct m_raster_depth *depth, int width, int minx, int miny, int maxx, int maxy, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2);
+MRAPI void m_raster_triangle_attn(float *dest, int comp, struct m_raster_depth *depth, int width, int height, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2);
+
+/* triangle mesh with 4 components attributes, binned in screen tiles rasterized in parallel
+   vertices: 4 floats per vertex (same as v0, v1, v2), attributes: 4 floats per vertex
+   indices: 3 per triangle, triangles are drawn in order inside each tile */
+#define M_RASTER_TILE_SIZE 64
+MRAPI void m_raster_mesh_att4(float *dest, int width, int height, float *vertices, float *attributes, int *indices, int count);
+MRAPI void m_raster_mesh_depth_att4(float *dest, struct m_raster_depth *depth, float *vertices, float *attributes, int *indices, int count);
+
+/* triangle mesh with comp components attributes per vertex, depth can be NULL */
+MRAPI void m_raster_mesh_attn(float *dest, int comp, struct m_raster_depth *depth, int width, int height, float *vertices, float *attributes, int *indices, int count);
+
+/* visibility buffer (deferred attribute interpolation):
+   ids receives the triangle index of each pixel (fill it with -1 first)
+   and bary 2 perspective correct barycentrics, then m_raster_resolve_attn
+   interpolates the attributes once per visible pixel (instead of once per overdrawn pixel) */
+MRAPI void m_raster_mesh_visibility(int *ids, float *bary, struct m_raster_depth *depth, int width, int height, float *vertices, int *indices, int count);
+MRAPI void m_raster_resolve_attn(float *dest, int comp, const int *ids, const float *bary, int width, int height, float *attributes, int *indices);
+
+/* clipping: clip space vertices (x, y, z, w, 4 floats) to screen space vertices (x, y, z / w, 1 / w)
+   mapping x and y from [-w, w] to [0, width] and [0, height]
+   triangles are clipped against the near plane (z >= -w) in homogeneous space,
+   the screen edges only against a guard band of M_RASTER_GUARD_BAND pixels
+   (the rasterizer scissors the rest), triangles outside the screen,
+   back-facing or degenerate are culled before setup.
+   dest_vertices and dest_attributes must hold vertex_count + count * M_RASTER_CLIP_MAX vertices,
+   dest_indices count * (M_RASTER_CLIP_MAX - 2) triangles, attributes can be NULL,
+   return the number of triangles to rasterize */
+#define M_RASTER_GUARD_BAND 4096
+#define M_RASTER_CLIP_MAX 8
+MRAPI int m_raster_clip(float *dest_vertices, float *dest_attributes, int *dest_indices, int comp, int width, int height, float *vertices, float *attributes, int vertex_count, int *indices, int count);
+
+/* clip and rasterize a mesh of clip space vertices (comp components attributes), depth can be NULL,
+   attributes can be NULL (depth only, dest is not written) */
+MRAPI void m_raster_mesh_clip_attn(float *dest, int comp, struct m_raster_depth *depth, int width, int height, float *vertices, float *attributes, int vertex_count, int *indices, int count);
+
+/* basic 2d rasterization (float 2 points), clipped to the image */
+MRAPI void m_raster_span(float *dest, int width, int height, int comp, int x0, int x1, int y, float *color);
 MRAPI void m_raster_line(float *dest, int width, int height, int comp, float *p0, float *p1, float *color);
+MRAPI void m_raster_line_thick(float *dest, int width, int height, int comp, float *p0, float *p1, float thickness, float *color);
 MRAPI void m_raster_circle(float *dest, int width, int height, int comp, float *p, float r, float *color);
+MRAPI void m_raster_circle_fill(float *dest, int width, int height, int comp, float *p, float r, float *color);
 MRAPI void m_raster_polygon(float *dest, int width, int height, int comp, float *points, int count, float *color);
 
+/* polygons (sorted edge table and active edge list): counts[polygon_count] points per polygon,
+   rule: M_RASTER_EVEN_ODD or M_RASTER_NON_ZERO (all the polygons form one shape, holes included),
+   aa: anti-aliased coverage (M_RASTER_AA_SUB sub-scanlines with exact horizontal coverage) */
+#define M_RASTER_EVEN_ODD 0
+#define M_RASTER_NON_ZERO 1
+#define M_RASTER_AA_SUB 4
+MRAPI void m_raster_polygons(float *dest, int width, int height, int comp, float *points, int *counts, int polygon_count, int rule, int aa, float *color);
+
+/* anti-aliased line (Wu), circle and disk (distance field),
+   color is blended over dest with the pixel coverage */
+MRAPI void m_raster_line_aa(float *dest, int width, int height, int comp, float *p0, float *p1, float *color);
+MRAPI void m_raster_circle_aa(float *dest, int width, int height, int comp, float *p, float r, float *color);
+MRAPI void m_raster_circle_fill_aa(float *dest, int width, int height, int comp, float *p, float r, float *color);
+
+/* exact area coverage (signed area accumulation, font rasterizer style):
+   acc (width * height floats, zero) accumulates the signed area of the polygon edges,
+   shapes can be accumulated with several calls before resolving,
+   m_raster_coverage_resolve integrates each row (prefix sum), blends color over dest
+   with the coverage (absolute value, saturated at 1) and clears acc
+   (exact for shapes that do not overlap themselves, holes need the opposite orientation) */
+MRAPI void m_raster_coverage_polygons(float *acc, int width, int height, float *points, int *counts, int polygon_count);
+MRAPI void m_raster_coverage_resolve(float *dest, int width, int height, int comp, float *acc, float *color);
+
+/* ubyte RGBA output (dest: width * height * 4 ubytes, color: RGBA ubyte),
+   same primitives written with a mode:
+   M_RASTER_OVERWRITE: dest = color (blended by the coverage of anti-aliased edges)
+   M_RASTER_ALPHA: color over dest with color alpha (straight alpha)
+   M_RASTER_ADD: dest + color * color alpha (saturated) */
+#define M_RASTER_OVERWRITE 0
+#define M_RASTER_ALPHA 1
+#define M_RASTER_ADD 2
+MRAPI void m_raster_span_ubyte(unsigned char *dest, int width, int height, int x0, int x1, int y, const unsigned char *color, int mode);
+MRAPI void m_raster_line_ubyte(unsigned char *dest, int width, int height, float *p0, float *p1, const unsigned char *color, int mode);
+MRAPI void m_raster_line_thick_ubyte(unsigned char *dest, int width, int height, float *p0, float *p1, float thickness, const unsigned char *color, int mode);
+MRAPI void m_raster_circle_ubyte(unsigned char *dest, int width, int height, float *p, float r, const unsigned char *color, int mode);
+MRAPI void m_raster_circle_fill_ubyte(unsigned char *dest, int width, int height, float *p, float r, const unsigned char *color, int mode);
+MRAPI void m_raster_polygon_ubyte(unsigned char *dest, int width, int height, float *points, int count, const unsigned char *color, int mode);
+MRAPI void m_raster_polygons_ubyte(unsigned char *dest, int width, int height, float *points, int *counts, int polygon_count, int rule, int aa, const unsigned char *color, int mode);
+MRAPI void m_raster_line_aa_ubyte(unsigned char *dest, int width, int height, float *p0, float *p1, const unsigned char *color, int mode);
+MRAPI void m_raster_circle_aa_ubyte(unsigned char *dest, int width, int height, float *p, float r, const unsigned char *color, int mode);
+MRAPI void m_raster_circle_fill_aa_ubyte(unsigned char *dest, int width, int height, float *p, float r, const unsigned char *color, int mode);
+MRAPI void m_raster_coverage_resolve_ubyte(unsigned char *dest, int width, int height, float *acc, const unsigned char *color, int mode);
+
 #ifdef __cplusplus
 }
 #endif
@@ -68,6 +186,8 @@ MRAPI void m_raster_polygon(float *dest, int width, int height, int comp, float
 
 #ifdef M_RASTER_IMPLEMENTATION
 
+#include <stdint.h>
+
 #ifndef M_MIN
 #define M_MIN(a, b) (((a) < (b)) ? (a) : (b))
 #endif
@@ -128,264 +248,1951 @@ MRAPI void m_raster_inv_bilerp(float *dest, float x, float y, const float *v0, c
    dest[1] = t;
 }
 
-MRAPI void m_raster_triangle_bbox_att4(float *dest, int width, int height, int minx, int miny, int maxx, int maxy, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2)
+#define M_RASTER_WRITE_ATT(c) pixel[c] = (up0[c] * t0 + up1[c] * t1 + up2[c] * it2) * w;
+#define M_RASTER_WRITE_1 {M_RASTER_WRITE_ATT(0)}
+#define M_RASTER_WRITE_2 {M_RASTER_WRITE_ATT(0) M_RASTER_WRITE_ATT(1)}
+#define M_RASTER_WRITE_3 {M_RASTER_WRITE_ATT(0) M_RASTER_WRITE_ATT(1) M_RASTER_WRITE_ATT(2)}
+#define M_RASTER_WRITE_4 {M_RASTER_WRITE_ATT(0) M_RASTER_WRITE_ATT(1) M_RASTER_WRITE_ATT(2) M_RASTER_WRITE_ATT(3)}
+#define M_RASTER_WRITE_N {int c; for (c = 0; c < comp; c++) M_RASTER_WRITE_ATT(c)}
+
+/* visibility: triangle id and perspective correct barycentrics */
+#define M_RASTER_WRITE_VIS {pixel[0] = t0 * v0[3] * w; pixel[1] = t1 * v1[3] * w; ids[y * width + x] = id;}
+
+/* top-left rule: the biased edge values are all positive or zero (sign bits) */
+#define M_RASTER_INSIDE ((e0 | e1 | e2) >= 0)
+
+/* pixels of the block (x0, y0, x1, y1) */
+#define M_RASTER_BLOCK_PIXELS(WRITE, STRIDE)\
+for (y = y0; y <= y1; y++) {\
+   float *pixel = data + (y * width + x0) * (STRIDE);\
+   float t0 = t0_blk + (y - y0) * deltaX2;\
+   float t1 = t1_blk + (y - y0) * deltaX0;\
+   int e0 = e0_blk + (y - y0) * e0_sy;\
+   int e1 = e1_blk + (y - y0) * e1_sy;\
+   int e2 = e2_blk + (y - y0) * e2_sy;\
+   int x;\
+   if (depth) {\
+      float *zrow = depth->data + y * depth->width;\
+      for (x = x0; x <= x1; x++) {\
+         if (M_RASTER_INSIDE) {\
+            float it2 = 1.0f - t0 - t1;\
+            float iw = t0 * v0[3] + t1 * v1[3] + it2 * v2[3];\
+            if (! ztest || iw > zrow[x]) {\
+               float w = 1.0f / iw;\
+               zrow[x] = iw;\
+               written = 1;\
+               WRITE\
+            }\
+         }\
+         t0 += deltaY1;\
+         t1 += deltaY2;\
+         e0 += e0_sx;\
+         e1 += e1_sx;\
+         e2 += e2_sx;\
+         pixel += (STRIDE);\
+      }\
+   }\
+   else if (full) {\
+      for (x = x0; x <= x1; x++) {\
+         float it2 = 1.0f - t0 - t1;\
+         float w = 1.0f / (t0 * v0[3] + t1 * v1[3] + it2 * v2[3]);\
+         WRITE\
+         t0 += deltaY1;\
+         t1 += deltaY2;\
+         pixel += (STRIDE);\
+      }\
+   }\
+   else {\
+      for (x = x0; x <= x1; x++) {\
+         if (M_RASTER_INSIDE) {\
+            float it2 = 1.0f - t0 - t1;\
+            float w = 1.0f / (t0 * v0[3] + t1 * v1[3] + it2 * v2[3]);\
+            WRITE\
+         }\
+         t0 += deltaY1;\
+         t1 += deltaY2;\
+         e0 += e0_sx;\
+         e1 += e1_sx;\
+         e2 += e2_sx;\
+         pixel += (STRIDE);\
+      }\
+   }\
+}
+
+/* snap to M_RASTER_SUBPIXEL fixed-point */
+static int m__raster_snap(float v)
+{
+   return (int)floorf(v * M_RASTER_SUBPIXEL + 0.5f);
+}
+
+/* first and last pixel of a fixed-point range (pixels are sampled at integer coordinates) */
+static int m__raster_ceil(int v)
+{
+   return v >= 0 ? (v + M_RASTER_SUBPIXEL - 1) / M_RASTER_SUBPIXEL : -((-v) / M_RASTER_SUBPIXEL);
+}
+
+static int m__raster_floor(int v)
+{
+   return v >= 0 ? v / M_RASTER_SUBPIXEL : -((-v + M_RASTER_SUBPIXEL - 1) / M_RASTER_SUBPIXEL);
+}
+
+/* block range of a fixed-point edge function (64 bits), the block is rejected if max < 0 */
+#define M_RASTER_EDGE_BLOCK(e, dx, dy, e_blk, e_min, e_max)\
+{\
+   int64_t ex = (int64_t)(x1 - x0) * (dx);\
+   int64_t ey = (int64_t)(y1 - y0) * (dy);\
+   e_blk = (e) + (int64_t)(x0 - minx) * (dx) + (int64_t)(y0 - miny) * (dy);\
+   e_min = e_blk + M_MIN(ex, 0) + M_MIN(ey, 0);\
+   e_max = e_blk + M_MAX(ex, 0) + M_MAX(ey, 0);\
+}
+
+/* triangle core: dest with comp components attributes,
+   or visibility (ids != NULL, dest receives 2 barycentrics per pixel),
+   optional depth test and write (depth can be NULL)
+
+   the vertices are snapped to 1 / M_RASTER_SUBPIXEL pixel and the coverage
+   uses exact integer edge functions with a top-left fill rule (watertight),
+   attributes are interpolated with float barycentrics */
+static void m__raster_triangle(float *dest, int comp, int *ids, int id, struct m_raster_depth *depth, int width, int minx, int miny, int maxx, int maxy, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2)
 {
    float *data = dest;
-   float *yline;
-   float up0[4], up1[4], up2[4];
-   float denom, idenom;
-   float t0_row, t1_row;
+   float up0[M_RASTER_MAX_ATT], up1[M_RASTER_MAX_ATT], up2[M_RASTER_MAX_ATT];
+   float idenom;
+   float t0_org, t1_org;
    float deltaX0, deltaX2, deltaY1, deltaY2;
-   int w = width;
-   int w4, mx4, y;
+   float dwx, dwy;
+   int64_t area, e0_org, e1_org, e2_org;
+   int64_t e0_dx, e0_dy, e1_dx, e1_dy, e2_dx, e2_dy;
+   int X0, Y0, X1, Y1, X2, Y2, PX, PY;
+   int bias0, bias1, bias2;
+   int bx, by, c;
 
-   /* denominator */
-   denom = (v1[0] - v2[0]) * (v2[1] - v0[1]) - (v1[1] - v2[1]) * (v2[0] - v0[0]);
-   if (denom >= 0.0f)
+   /* the depth buffer has its own size (width is the row size of dest and ids) */
+   if (depth) {
+      maxx = M_MIN(maxx, depth->width - 1);
+      maxy = M_MIN(maxy, depth->height - 1);
+   }
+   if (minx > maxx || miny > maxy)
       return;
-   
-   idenom = 1.0f / denom;
 
-   /* scanline */
-   t0_row = ((v2[0] - v1[0]) * (miny-v1[1]) - (v2[1] - v1[1]) * (minx - v1[0])) * idenom;
-   t1_row = ((v0[0] - v2[0]) * (miny-v2[1]) - (v0[1] - v2[1]) * (minx - v2[0])) * idenom;
-   
-   deltaX0 = (v0[0] - v2[0]) * idenom;
-   deltaX2 = (v2[0] - v1[0]) * idenom;
-   deltaY1 = (v1[1] - v2[1]) * idenom;
-   deltaY2 = (v2[1] - v0[1]) * idenom;
+   X0 = m__raster_snap(v0[0]); Y0 = m__raster_snap(v0[1]);
+   X1 = m__raster_snap(v1[0]); Y1 = m__raster_snap(v1[1]);
+   X2 = m__raster_snap(v2[0]); Y2 = m__raster_snap(v2[1]);
 
-   up0[0] = a0[0] * v0[3]; up0[1] = a0[1] * v0[3]; up0[2] = a0[2] * v0[3]; up0[3] = a0[3] * v0[3];
-   up1[0] = a1[0] * v1[3]; up1[1] = a1[1] * v1[3]; up1[2] = a1[2] * v1[3]; up1[3] = a1[3] * v1[3];
-   up2[0] = a2[0] * v2[3]; up2[1] = a2[1] * v2[3]; up2[2] = a2[2] * v2[3]; up2[3] = a2[3] * v2[3];
+   /* twice the area (front faces are positive) */
+   area = (int64_t)(X2 - X1) * (Y2 - Y0) - (int64_t)(Y2 - Y1) * (X2 - X0);
+   if (area <= 0)
+      return;
 
-   w4 = w * 4;
-   mx4 = minx * 4;
-   
-   yline = data + miny * w4;
-   for (y = miny; y <= maxy; y++) {
+   /* edge functions at (minx, miny) and their per-pixel steps,
+      e0 and e1 are proportional to the barycentrics t0 and t1, e0 + e1 + e2 = area */
+   PX = minx * M_RASTER_SUBPIXEL;
+   PY = miny * M_RASTER_SUBPIXEL;
+   e0_org = (int64_t)(Y2 - Y1) * (PX - X1) - (int64_t)(X2 - X1) * (PY - Y1);
+   e1_org = (int64_t)(Y0 - Y2) * (PX - X2) - (int64_t)(X0 - X2) * (PY - Y2);
+   e2_org = area - e0_org - e1_org;
+   e0_dx = (int64_t)(Y2 - Y1) * M_RASTER_SUBPIXEL; e0_dy = (int64_t)(X1 - X2) * M_RASTER_SUBPIXEL;
+   e1_dx = (int64_t)(Y0 - Y2) * M_RASTER_SUBPIXEL; e1_dy = (int64_t)(X2 - X0) * M_RASTER_SUBPIXEL;
+   e2_dx = (int64_t)(Y1 - Y0) * M_RASTER_SUBPIXEL; e2_dy = (int64_t)(X0 - X1) * M_RASTER_SUBPIXEL;
 
-      float *pixel = yline + mx4;
-      float t0 = t0_row;
-      float t1 = t1_row;
-      int x;
-      
-      for (x = minx; x <= maxx; x++) {
+   /* top-left rule: samples exactly on an edge belong to it only if the edge is
+      a left edge (interior toward +x) or a top edge (horizontal, interior toward +y) */
+   bias0 = (e0_dx > 0 || (e0_dx == 0 && e0_dy > 0)) ? 0 : -1;
+   bias1 = (e1_dx > 0 || (e1_dx == 0 && e1_dy > 0)) ? 0 : -1;
+   bias2 = (e2_dx > 0 || (e2_dx == 0 && e2_dy > 0)) ? 0 : -1;
+   e0_org += bias0;
+   e1_org += bias1;
+   e2_org += bias2;
+
+   /* float barycentrics at (minx, miny) and their gradients */
+   idenom = 1.0f / (float)area;
+   t0_org = (float)(e0_org - bias0) * idenom;
+   t1_org = (float)(e1_org - bias1) * idenom;
+   deltaY1 = (float)e0_dx * idenom;
+   deltaX2 = (float)e0_dy * idenom;
+   deltaY2 = (float)e1_dx * idenom;
+   deltaX0 = (float)e1_dy * idenom;
+
+   /* gradient of the interpolated v[3] (depth) */
+   dwx = deltaY1 * (v0[3] - v2[3]) + deltaY2 * (v1[3] - v2[3]);
+   dwy = deltaX2 * (v0[3] - v2[3]) + deltaX0 * (v1[3] - v2[3]);
+
+   if (ids == NULL) {
+      for (c = 0; c < comp; c++) {
+         up0[c] = a0[c] * v0[3];
+         up1[c] = a1[c] * v1[3];
+         up2[c] = a2[c] * v2[3];
+      }
+   }
+
+   /* blocks of M_RASTER_BLOCK * M_RASTER_BLOCK pixels (aligned on the screen with depth):
+      the edge functions and the depth are linear, so testing the block corners
+      rejects empty or hidden blocks and accepts fully covered ones without per-pixel tests */
+   for (by = depth ? miny - (miny % M_RASTER_BLOCK) : miny; by <= maxy; by += M_RASTER_BLOCK) {
+
+      int y0 = M_MAX(by, miny);
+      int y1 = M_MIN(by + M_RASTER_BLOCK - 1, maxy);
+
+      for (bx = depth ? minx - (minx % M_RASTER_BLOCK) : minx; bx <= maxx; bx += M_RASTER_BLOCK) {
+
+         int x0 = M_MAX(bx, minx);
+         int x1 = M_MIN(bx + M_RASTER_BLOCK - 1, maxx);
+         int64_t e0_blk64, e0_min, e0_max;
+         int64_t e1_blk64, e1_min, e1_max;
+         int64_t e2_blk64, e2_min, e2_max;
+         float t0_blk, t1_blk;
+         float *zblock = NULL;
+         int e0_blk = 0, e0_sx = 0, e0_sy = 0;
+         int e1_blk = 0, e1_sx = 0, e1_sy = 0;
+         int e2_blk = 0, e2_sx = 0, e2_sy = 0;
+         int full, ztest = 0, written = 0;
+         int y;
+
+         M_RASTER_EDGE_BLOCK(e0_org, e0_dx, e0_dy, e0_blk64, e0_min, e0_max)
+         M_RASTER_EDGE_BLOCK(e1_org, e1_dx, e1_dy, e1_blk64, e1_min, e1_max)
+         M_RASTER_EDGE_BLOCK(e2_org, e2_dx, e2_dy, e2_blk64, e2_min, e2_max)
+
+         if (e0_max < 0 || e1_max < 0 || e2_max < 0)
+            continue;
+
+         full = (e0_min >= 0 && e1_min >= 0 && e2_min >= 0);
 
-         float t2 = t0 + t1;
-         if (t0 >= 0.0f && t1 >= 0.0f && t2 <= 1.0f) {
+         /* per-pixel edge values: the edges crossing the block fit in 32 bits,
+            the edges covering it are replaced by a constant */
+         if (e0_min < 0) { e0_blk = (int)e0_blk64; e0_sx = (int)e0_dx; e0_sy = (int)e0_dy; }
+         if (e1_min < 0) { e1_blk = (int)e1_blk64; e1_sx = (int)e1_dx; e1_sy = (int)e1_dy; }
+         if (e2_min < 0) { e2_blk = (int)e2_blk64; e2_sx = (int)e2_dx; e2_sy = (int)e2_dy; }
 
-            float it2 = 1.0f - t2;
-            float w = 1.0f / (t0 * v0[3] + t1 * v1[3] + it2 * v2[3]);
+         t0_blk = t0_org + (x0 - minx) * deltaY1 + (y0 - miny) * deltaX2;
+         t1_blk = t1_org + (x0 - minx) * deltaY2 + (y0 - miny) * deltaX0;
 
-            pixel[0] = (up0[0] * t0 + up1[0] * t1 + up2[0] * it2) * w;
-            pixel[1] = (up0[1] * t0 + up1[1] * t1 + up2[1] * it2) * w;
-            pixel[2] = (up0[2] * t0 + up1[2] * t1 + up2[2] * it2) * w;
-            pixel[3] = (up0[3] * t0 + up1[3] * t1 + up2[3] * it2) * w;
+         if (depth) {
+
+            float sx = (float)(x1 - x0);
+            float sy = (float)(y1 - y0);
+            float iw_blk = t0_blk * v0[3] + t1_blk * v1[3] + (1.0f - t0_blk - t1_blk) * v2[3];
+            float iw_min = iw_blk + M_MIN(sx * dwx, 0.0f) + M_MIN(sy * dwy, 0.0f);
+            float iw_max = iw_blk + M_MAX(sx * dwx, 0.0f) + M_MAX(sy * dwy, 0.0f);
+
+            zblock = depth->blocks + ((by / M_RASTER_BLOCK) * depth->bw + (bx / M_RASTER_BLOCK)) * 2;
+            if (iw_max <= zblock[0]) /* hidden */
+               continue;
+
+            ztest = !(iw_min > zblock[1]); /* else everything passes */
          }
 
-         t0 += deltaY1;
-         t1 += deltaY2;
-         pixel += 4;
-      }
+         if (ids) {
+            M_RASTER_BLOCK_PIXELS(M_RASTER_WRITE_VIS, 2)
+         }
+         else {
+            switch (comp) {
+            case 1: M_RASTER_BLOCK_PIXELS(M_RASTER_WRITE_1, 1) break;
+            case 2: M_RASTER_BLOCK_PIXELS(M_RASTER_WRITE_2, 2) break;
+            case 3: M_RASTER_BLOCK_PIXELS(M_RASTER_WRITE_3, 3) break;
+            case 4: M_RASTER_BLOCK_PIXELS(M_RASTER_WRITE_4, 4) break;
+            default: M_RASTER_BLOCK_PIXELS(M_RASTER_WRITE_N, comp) break;
+            }
+         }
+
+         /* update the block farthest and nearest depth */
+         if (written) {
 
-      t0_row += deltaX2;
-      t1_row += deltaX0;
-      yline += w4;
+            int ex = M_MIN(bx + M_RASTER_BLOCK, depth->width);
+            int ey = M_MIN(by + M_RASTER_BLOCK, depth->height);
+            float zmin = depth->data[by * depth->width + bx];
+            float zmax = zmin;
+
+            for (y = by; y < ey; y++) {
+               float *zrow = depth->data + y * depth->width;
+               int x;
+               for (x = bx; x < ex; x++) {
+                  zmin = M_MIN(zmin, zrow[x]);
+                  zmax = M_MAX(zmax, zrow[x]);
+               }
+            }
+
+            zblock[0] = zmin;
+            zblock[1] = zmax;
+         }
+      }
    }
 }
 
-MRAPI void m_raster_triangle_att4(float *dest, int width, int height, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2)
+MRAPI void m_raster_triangle_bbox_att4(float *dest, int width, int height, int minx, int miny, int maxx, int maxy, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2)
+{
+   m__raster_triangle(dest, 4, NULL, 0, NULL, width, minx, miny, maxx, maxy, v0, v1, v2, a0, a1, a2);
+}
+
+MRAPI void m_raster_triangle_bbox_depth_att4(float *dest, struct m_raster_depth *depth, int minx, int miny, int maxx, int maxy, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2)
+{
+   m__raster_triangle(dest, 4, NULL, 0, depth, depth->width, minx, miny, maxx, maxy, v0, v1, v2, a0, a1, a2);
+}
+
+MRAPI void m_raster_triangle_bbox_attn(float *dest, int comp, struct m_raster_depth *depth, int width, int minx, int miny, int maxx, int maxy, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2)
+{
+   m__raster_triangle(dest, comp, NULL, 0, depth, width, minx, miny, maxx, maxy, v0, v1, v2, a0, a1, a2);
+}
+
+MRAPI void m_raster_depth_create(struct m_raster_depth *depth, int width, int height)
+{
+   depth->width = width;
+   depth->height = height;
+   depth->bw = (width + M_RASTER_BLOCK - 1) / M_RASTER_BLOCK;
+   depth->bh = (height + M_RASTER_BLOCK - 1) / M_RASTER_BLOCK;
+   depth->data = (float *)malloc(width * height * sizeof(float));
+   depth->blocks = (float *)malloc(depth->bw * depth->bh * 2 * sizeof(float));
+   m_raster_depth_clear(depth);
+}
+
+MRAPI void m_raster_depth_destroy(struct m_raster_depth *depth)
+{
+   free(depth->blocks);
+   free(depth->data);
+}
+
+MRAPI void m_raster_depth_clear(struct m_raster_depth *depth)
+{
+   memset(depth->data, 0, depth->width * depth->height * sizeof(float));
+   memset(depth->blocks, 0, depth->bw * depth->bh * 2 * sizeof(float));
+}
+
+/* clipped bounding box (minx, miny, maxx, maxy), return 0 if the triangle is not visible */
+static int m__raster_triangle_bbox(int *bbox, int width, int height, float *v0, float *v1, float *v2)
 {
    int minx, maxx, miny, maxy;
    int w = width;
    int h = height;
 
-   if (v0[3] <= 0.0f || v1[3] <= 0.0f || v2[3] <= 0.0f) /* no clip */
-      return;
+   if (v0[3] <= 0.0f || v1[3] <= 0.0f || v2[3] <= 0.0f) /* no clip (see m_raster_clip) */
+      return 0;
 
-   /* bounding box */
-   M_FIND_MIN_MAX_3((int)v0[0], (int)v1[0], (int)v2[0], minx, maxx);
-   M_FIND_MIN_MAX_3((int)v0[1], (int)v1[1], (int)v2[1], miny, maxy);
-   minx = M_MAX(minx, 0);
-   miny = M_MAX(miny, 0);
-   maxx = M_MIN(maxx, w - 1);
-   maxy = M_MIN(maxy, h - 1);
+   /* bounding box of the covered pixels (snapped vertices) */
+   M_FIND_MIN_MAX_3(m__raster_snap(v0[0]), m__raster_snap(v1[0]), m__raster_snap(v2[0]), minx, maxx);
+   M_FIND_MIN_MAX_3(m__raster_snap(v0[1]), m__raster_snap(v1[1]), m__raster_snap(v2[1]), miny, maxy);
+   bbox[0] = M_MAX(m__raster_ceil(minx), 0);
+   bbox[1] = M_MAX(m__raster_ceil(miny), 0);
+   bbox[2] = M_MIN(m__raster_floor(maxx), w - 1);
+   bbox[3] = M_MIN(m__raster_floor(maxy), h - 1);
 
-   m_raster_triangle_bbox_att4(dest, width, height, minx, miny, maxx, maxy, v0, v1, v2, a0, a1, a2);
+   return bbox[0] <= bbox[2] && bbox[1] <= bbox[3];
 }
 
-MRAPI void m_raster_line(float *dest, int width, int height, int comp, float *p0, float *p1, float *color)
+MRAPI void m_raster_triangle_att4(float *dest, int width, int height, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2)
 {
-   float *data = dest;
-   int x0 = (int)p0[0];
-   int y0 = (int)p0[1];
-   int x1 = (int)p1[0];
-   int y1 = (int)p1[1];
-   int w = width;
-   int h = height;
-   int dx =  M_ABS(x1 - x0), sx = x0 < x1 ? 1 : -1;
-   int dy = -M_ABS(y1 - y0), sy = y0 < y1 ? 1 : -1;
-   int err = dx + dy, e2;
+   int bbox[4];
 
-   while (1) {
+   if (m__raster_triangle_bbox(bbox, width, height, v0, v1, v2))
+      m_raster_triangle_bbox_att4(dest, width, height, bbox[0], bbox[1], bbox[2], bbox[3], v0, v1, v2, a0, a1, a2);
+}
 
-      if (x0 > -1 && y0 > -1 && x0 < w && y0 < h) { /* safe, but should be taken out of the loop for speed (clipping ?) */
-         float *pixel = data + (y0 * w + x0) * comp; int c;
-         for (c = 0; c < comp; c++)
-            pixel[c] = color[c];
+MRAPI void m_raster_triangle_depth_att4(float *dest, struct m_raster_depth *depth, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2)
+{
+   int bbox[4];
+
+   if (m__raster_triangle_bbox(bbox, depth->width, depth->height, v0, v1, v2))
+      m_raster_triangle_bbox_depth_att4(dest, depth, bbox[0], bbox[1], bbox[2], bbox[3], v0, v1, v2, a0, a1, a2);
+}
+
+MRAPI void m_raster_triangle_attn(float *dest, int comp, struct m_raster_depth *depth, int width, int height, float *v0, float *v1, float *v2, float *a0, float *a1, float *a2)
+{
+   int bbox[4];
+
+   if (m__raster_triangle_bbox(bbox, width, height, v0, v1, v2))
+      m__raster_triangle(dest, comp, NULL, 0, depth, width, bbox[0], bbox[1], bbox[2], bbox[3], v0, v1, v2, a0, a1, a2);
+}
+
+static void m__raster_mesh(float *dest, int comp, int *ids, struct m_raster_depth *depth, int width, int height, float *vertices, float *attributes, int *indices, int count)
+{
+   int ts = M_RASTER_TILE_SIZE;
+   int tw = (width + ts - 1) / ts;
+   int th = (height + ts - 1) / ts;
+   int tile_count = tw * th;
+   int *bboxes, *offsets, *cursor, *bins;
+   int i, t;
+
+   if (count < 1 || tile_count < 1)
+      return;
+
+   bboxes = (int *)malloc(count * 4 * sizeof(int));
+   offsets = (int *)calloc(tile_count + 1, sizeof(int));
+   cursor = (int *)malloc(tile_count * sizeof(int));
+
+   /* count the triangles of each tile */
+   for (i = 0; i < count; i++) {
+
+      int *bbox = bboxes + i * 4;
+      int *id = indices + i * 3;
+      int tx, ty;
+
+      if (! m__raster_triangle_bbox(bbox, width, height, vertices + id[0] * 4, vertices + id[1] * 4, vertices + id[2] * 4)) {
+         bbox[0] = 1; bbox[2] = 0; /* empty */
+         continue;
+      }
+
+      for (ty = bbox[1] / ts; ty <= bbox[3] / ts; ty++)
+         for (tx = bbox[0] / ts; tx <= bbox[2] / ts; tx++)
+            offsets[ty * tw + tx + 1]++;
+   }
+
+   for (t = 0; t < tile_count; t++) {
+      cursor[t] = offsets[t];
+      offsets[t + 1] += offsets[t];
+   }
+
+   /* bin (in submission order) */
+   bins = (int *)malloc(M_MAX(offsets[tile_count], 1) * sizeof(int));
+   for (i = 0; i < count; i++) {
+
+      int *bbox = bboxes + i * 4;
+      int tx, ty;
+
+      if (bbox[0] > bbox[2])
+         continue;
+
+      for (ty = bbox[1] / ts; ty <= bbox[3] / ts; ty++)
+         for (tx = bbox[0] / ts; tx <= bbox[2] / ts; tx++)
+            bins[cursor[ty * tw + tx]++] = i;
+   }
+
+   /* rasterize tiles (each thread owns its tile pixels and depth blocks) */
+   #pragma omp parallel for schedule(dynamic, 1)
+   for (t = 0; t < tile_count; t++) {
+
+      int x0 = (t % tw) * ts;
+      int y0 = (t / tw) * ts;
+      int x1 = M_MIN(x0 + ts, width) - 1;
+      int y1 = M_MIN(y0 + ts, height) - 1;
+      int b;
+
+      for (b = offsets[t]; b < offsets[t + 1]; b++) {
+
+         int *bbox = bboxes + bins[b] * 4;
+         int *id = indices + bins[b] * 3;
+         float *a0 = NULL, *a1 = NULL, *a2 = NULL;
+
+         if (attributes) {
+            a0 = attributes + id[0] * comp;
+            a1 = attributes + id[1] * comp;
+            a2 = attributes + id[2] * comp;
+         }
+
+         m__raster_triangle(dest, comp, ids, bins[b], depth, width,
+            M_MAX(bbox[0], x0), M_MAX(bbox[1], y0), M_MIN(bbox[2], x1), M_MIN(bbox[3], y1),
+            vertices + id[0] * 4, vertices + id[1] * 4, vertices + id[2] * 4,
+            a0, a1, a2);
       }
-      
-      if (x0 == x1 && y0 == y1)
-         break;
-      
-      e2 = 2 * err;
-      if (e2 >= dy) { err += dy; x0 += sx; }
-      if (e2 <= dx) { err += dx; y0 += sy; }
    }
+
+   free(bins);
+   free(cursor);
+   free(offsets);
+   free(bboxes);
 }
 
-// Midpoint Circle Algorithm : http://en[3]ikipedia.org/wiki/Midpoint_circle_algorithm
-MRAPI void m_raster_circle(float *dest, int width, int height, int comp, float *p, float r, float *color)
+MRAPI void m_raster_mesh_att4(float *dest, int width, int height, float *vertices, float *attributes, int *indices, int count)
 {
-   #define M_CIRCLE_PIXEL(px, py)\
-   {\
-      int x2 = px;\
-      int y2 = py;\
-      if (x2 > -1 && y2 > -1 && x2 < w && y2 < h) {\
-         float *pixel = data + (y2 * w + x2) * comp; int c;\
-         for (c = 0; c < comp; c++)\
-            pixel[c] = color[c];\
-      }\
-   }
+   m__raster_mesh(dest, 4, NULL, NULL, width, height, vertices, attributes, indices, count);
+}
 
-   float *data = dest;
-   int x0 = (int)p[0];
-   int y0 = (int)p[1];
-   int radius = (int)r;
-   int w = width;
-   int h = height;
-   int x = radius, y = 0;
-   int radius_error = 1 - x;
- 
-   while (x >= y) {
+MRAPI void m_raster_mesh_depth_att4(float *dest, struct m_raster_depth *depth, float *vertices, float *attributes, int *indices, int count)
+{
+   m__raster_mesh(dest, 4, NULL, depth, depth->width, depth->height, vertices, attributes, indices, count);
+}
 
-      M_CIRCLE_PIXEL( x + x0,  y + y0)
-      M_CIRCLE_PIXEL( y + x0,  x + y0)
-      M_CIRCLE_PIXEL(-x + x0,  y + y0)
-      M_CIRCLE_PIXEL(-y + x0,  x + y0)
-      M_CIRCLE_PIXEL(-x + x0, -y + y0)
-      M_CIRCLE_PIXEL(-y + x0, -x + y0)
-      M_CIRCLE_PIXEL( x + x0, -y + y0)
-      M_CIRCLE_PIXEL( y + x0, -x + y0)
-      y++;
-        
-      if (radius_error < 0)
-         radius_error += 2 * y + 1;
-      else {
-         x--;
-         radius_error += 2 * (y - x + 1);
+MRAPI void m_raster_mesh_attn(float *dest, int comp, struct m_raster_depth *depth, int width, int height, float *vertices, float *attributes, int *indices, int count)
+{
+   m__raster_mesh(dest, comp, NULL, depth, width, height, vertices, attributes, indices, count);
+}
+
+MRAPI void m_raster_mesh_visibility(int *ids, float *bary, struct m_raster_depth *depth, int width, int height, float *vertices, int *indices, int count)
+{
+   m__raster_mesh(bary, 0, ids, depth, width, height, vertices, NULL, indices, count);
+}
+
+MRAPI void m_raster_resolve_attn(float *dest, int comp, const int *ids, const float *bary, int width, int height, float *attributes, int *indices)
+{
+   int y;
+
+   #pragma omp parallel for schedule(dynamic, 8)
+   for (y = 0; y < height; y++) {
+
+      const int *idrow = ids + y * width;
+      const float *b = bary + y * width * 2;
+      float *pixel = dest + y * width * comp;
+      int x, c;
+
+      for (x = 0; x < width; x++) {
+
+         if (idrow[x] >= 0) {
+
+            int *id = indices + idrow[x] * 3;
+            float *a0 = attributes + id[0] * comp;
+            float *a1 = attributes + id[1] * comp;
+            float *a2 = attributes + id[2] * comp;
+            float b0 = b[0];
+            float b1 = b[1];
+            float b2 = 1.0f - b0 - b1;
+
+            for (c = 0; c < comp; c++)
+               pixel[c] = a0[c] * b0 + a1[c] * b1 + a2[c] * b2;
+         }
+
+         b += 2;
+         pixel += comp;
       }
    }
+}
 
-   #undef M_CIRCLE_PIXEL
+/* clipping outcodes */
+#define M_RASTER_CLIP_NEAR   1
+#define M_RASTER_CLIP_GUARD  (2 | 4 | 8 | 16)
+#define M_RASTER_CLIP_SCREEN (1 | 32 | 64 | 128 | 256)
+
+static int m__raster_outcode(const float *v, float gx, float gy)
+{
+   int code = 0;
+   if (v[2] < -v[3] || v[3] <= 0.0f) code |= 1;
+   if (v[0] < -gx * v[3]) code |= 2;
+   if (v[0] > gx * v[3])  code |= 4;
+   if (v[1] < -gy * v[3]) code |= 8;
+   if (v[1] > gy * v[3])  code |= 16;
+   if (v[0] < -v[3]) code |= 32;
+   if (v[0] > v[3])  code |= 64;
+   if (v[1] < -v[3]) code |= 128;
+   if (v[1] > v[3])  code |= 256;
+   return code;
 }
 
-/* adapted from : http://alienryderflex.com/polygon_fill/
-   public-domain code by Darel Rex Finley, 2007
-*/
-MRAPI void m_raster_polygon(float *dest, int width, int height, int comp, float *points, int count, float *color)
+/* clip space (x, y, z, w) to screen space (x, y, z, 1 / w) */
+static void m__raster_project(float *dest, const float *v, float hw, float hh)
 {
-   float *data = dest;
-   int *nodeX;
-   int w = width;
-   int h = height;
-   int pixelY;
-   int IMAGE_LEFT, IMAGE_RIGHT;
-   int IMAGE_TOP, IMAGE_BOT;
+   if (v[3] > 0.0f) {
+      float iw = 1.0f / v[3];
+      dest[0] = (v[0] * iw + 1.0f) * hw;
+      dest[1] = (v[1] * iw + 1.0f) * hh;
+      dest[2] = v[2] * iw;
+      dest[3] = iw;
+   }
+   else {
+      dest[0] = dest[1] = dest[2] = dest[3] = 0.0f; /* never rasterized */
+   }
+}
 
-   if (count < 3)
-      return;
-   
-   nodeX = (int *)malloc(count * sizeof(int));
-   
-   /* bounding box */
-   {
-      float *point = points;
-      float min[2], max[2]; int i;
+/* front facing and not degenerate once snapped (same test as the triangle setup) */
+static int m__raster_front(const float *v0, const float *v1, const float *v2)
+{
+   int X0 = m__raster_snap(v0[0]), Y0 = m__raster_snap(v0[1]);
+   int X1 = m__raster_snap(v1[0]), Y1 = m__raster_snap(v1[1]);
+   int X2 = m__raster_snap(v2[0]), Y2 = m__raster_snap(v2[1]);
+   return ((int64_t)(X2 - X1) * (Y2 - Y0) - (int64_t)(Y2 - Y1) * (X2 - X0)) > 0;
+}
+
+/* Sutherland-Hodgman against one plane in homogeneous space,
+   a vertex is (x, y, z, w) followed by its attributes (stride floats) */
+static int m__raster_clip_plane(float *dest, const float *src, int count, int stride, int plane, float gx, float gy)
+{
+   float d[M_RASTER_CLIP_MAX];
+   int i, n = 0;
 
-      min[0] = point[0];
-	   max[0] = point[0];
-	   min[1] = point[1];
-	   max[1] = point[1];
-	   point += 2;
+   for (i = 0; i < count; i++) {
+      const float *v = src + i * stride;
+      switch (plane) {
+      case 1:  d[i] = v[2] + v[3]; break;
+      case 2:  d[i] = gx * v[3] + v[0]; break;
+      case 4:  d[i] = gx * v[3] - v[0]; break;
+      case 8:  d[i] = gy * v[3] + v[1]; break;
+      default: d[i] = gy * v[3] - v[1]; break;
+      }
+   }
+
+   for (i = 0; i < count; i++) {
+
+      int j = (i + 1) % count;
+      const float *a = src + i * stride;
+      const float *b = src + j * stride;
 
-      for (i = 1; i < count; i++) {
-         min[0] = M_MIN(min[0], point[0]);
-         min[1] = M_MIN(min[1], point[1]);
-         max[0] = M_MAX(max[0], point[0]);
-         max[1] = M_MAX(max[1], point[1]);
-         point += 2;
+      if (d[i] >= 0.0f) {
+         memcpy(dest + n * stride, a, stride * sizeof(float));
+         n++;
       }
 
-      IMAGE_LEFT =  M_MAX(0, (int)min[0]);
-      IMAGE_TOP =   M_MAX(0, (int)min[1]);
-      IMAGE_RIGHT = M_MIN(w - 1, (int)max[0] + 1);
-      IMAGE_BOT =   M_MIN(h - 1, (int)max[1] + 1);
+      if ((d[i] >= 0.0f) != (d[j] >= 0.0f)) {
+         float *v = dest + n * stride;
+         float t = d[i] / (d[i] - d[j]);
+         int c;
+         for (c = 0; c < stride; c++)
+            v[c] = a[c] + (b[c] - a[c]) * t;
+         n++;
+      }
    }
 
-   /* loop through the rows of the image. */
-   for (pixelY = IMAGE_TOP; pixelY < IMAGE_BOT; pixelY++) {
+   return n;
+}
 
-      /* build a list of nodes. */
-      float *pointi, *pointj;
-      int nodes = 0;
-      int i, j;
+MRAPI int m_raster_clip(float *dest_vertices, float *dest_attributes, int *dest_indices, int comp, int width, int height, float *vertices, float *attributes, int vertex_count, int *indices, int count)
+{
+   float poly[2][M_RASTER_CLIP_MAX * (4 + M_RASTER_MAX_ATT)];
+   float gx = 1.0f + (2.0f * M_RASTER_GUARD_BAND) / (float)width;
+   float gy = 1.0f + (2.0f * M_RASTER_GUARD_BAND) / (float)height;
+   float hw = width * 0.5f;
+   float hh = height * 0.5f;
+   int *codes;
+   int stride;
+   int vcount = vertex_count;
+   int tcount = 0;
+   int i;
 
-      pointi = points;
-      pointj = points + ((count - 1) * 2);
+   if (attributes == NULL)
+      comp = 0;
+   stride = 4 + comp;
 
-      for (i = 0; i < count; i++) {
-         if ((pointi[1] < (float)pixelY && pointj[1] >= (float)pixelY) ||
-             (pointj[1] < (float)pixelY && pointi[1] >= (float)pixelY))
-            nodeX[nodes++] = (int)(pointi[0] + (pixelY - pointi[1]) / (pointj[1] - pointi[1]) * (pointj[0] - pointi[0]));
-         pointj = pointi;
-         pointi += 2;
-      }
-
-      /*  sort the nodes, via a simple Bubble sort. */
-      i = 0;
-      while (i < (nodes - 1)) {
-         if (nodeX[i] > nodeX[i + 1]) {
-            int swap = nodeX[i]; nodeX[i] = nodeX[i + 1]; nodeX[i + 1] = swap; if (i) i--;
+   codes = (int *)malloc(M_MAX(vertex_count, 1) * sizeof(int));
+
+   /* project the shared vertices once */
+   #pragma omp parallel for schedule(dynamic, 256)
+   for (i = 0; i < vertex_count; i++) {
+      codes[i] = m__raster_outcode(vertices + i * 4, gx, gy);
+      m__raster_project(dest_vertices + i * 4, vertices + i * 4, hw, hh);
+   }
+
+   if (comp > 0)
+      memcpy(dest_attributes, attributes, vertex_count * comp * sizeof(float));
+
+   for (i = 0; i < count; i++) {
+
+      int *id = indices + i * 3;
+      int c0 = codes[id[0]];
+      int c1 = codes[id[1]];
+      int c2 = codes[id[2]];
+      int clip = (c0 | c1 | c2) & (M_RASTER_CLIP_NEAR | M_RASTER_CLIP_GUARD);
+      int plane, n, k, cur;
+
+      /* outside the screen or behind the camera */
+      if ((c0 & c1 & c2) & M_RASTER_CLIP_SCREEN)
+         continue;
+
+      /* inside the guard band: no clipping */
+      if (clip == 0) {
+         if (m__raster_front(dest_vertices + id[0] * 4, dest_vertices + id[1] * 4, dest_vertices + id[2] * 4)) {
+            int *out = dest_indices + tcount * 3;
+            out[0] = id[0];
+            out[1] = id[1];
+            out[2] = id[2];
+            tcount++;
          }
-         else i++;
+         continue;
+      }
+
+      /* clip the crossed planes */
+      for (k = 0; k < 3; k++) {
+         float *v = poly[0] + k * stride;
+         memcpy(v, vertices + id[k] * 4, 4 * sizeof(float));
+         if (comp > 0)
+            memcpy(v + 4, attributes + id[k] * comp, comp * sizeof(float));
       }
 
-      /* fill the pixels between node pairs. */
-      for (i = 0; i < nodes; i += 2) {
+      n = 3;
+      cur = 0;
+      for (plane = 1; plane <= 16 && n >= 3; plane <<= 1) {
+         if (clip & plane) {
+            n = m__raster_clip_plane(poly[!cur], poly[cur], n, stride, plane, gx, gy);
+            cur = !cur;
+         }
+      }
 
-         if (nodeX[i] >= IMAGE_RIGHT)
-            break;
-            
-         if (nodeX[i + 1] > IMAGE_LEFT) {
+      if (n < 3)
+         continue;
 
-            float *pixel;
-            nodeX[i]     = M_MAX(nodeX[i], IMAGE_LEFT);
-            nodeX[i + 1] = M_MIN(nodeX[i + 1], IMAGE_RIGHT);
-            pixel = data + (pixelY * w + nodeX[i]) * comp;
+      /* project and fan triangulate */
+      for (k = 0; k < n; k++) {
+         float *v = poly[cur] + k * stride;
+         m__raster_project(dest_vertices + (vcount + k) * 4, v, hw, hh);
+         if (comp > 0)
+            memcpy(dest_attributes + (vcount + k) * comp, v + 4, comp * sizeof(float));
+      }
 
-            for (j = nodeX[i]; j < nodeX[i + 1]; j++) {
-               int c;
-               for (c = 0; c < comp; c++)
-                  pixel[c] = color[c];
-               pixel += comp;
-            }
+      for (k = 2; k < n; k++) {
+         float *v0 = dest_vertices + vcount * 4;
+         float *v1 = dest_vertices + (vcount + k - 1) * 4;
+         float *v2 = dest_vertices + (vcount + k) * 4;
+         if (m__raster_front(v0, v1, v2)) {
+            int *out = dest_indices + tcount * 3;
+            out[0] = vcount;
+            out[1] = vcount + k - 1;
+            out[2] = vcount + k;
+            tcount++;
          }
       }
+
+      vcount += n;
    }
-   
-   free(nodeX);
+
+   free(codes);
+   return tcount;
+}
+
+MRAPI void m_raster_mesh_clip_attn(float *dest, int comp, struct m_raster_depth *depth, int width, int height, float *vertices, float *attributes, int vertex_count, int *indices, int count)
+{
+   int max_vertices = vertex_count + count * M_RASTER_CLIP_MAX;
+   int att_comp = attributes ? comp : 0; /* depth only without attributes (as m_raster_clip) */
+   float *clip_vertices = (float *)malloc(max_vertices * 4 * sizeof(float));
+   float *clip_attributes = (float *)malloc(M_MAX(max_vertices * att_comp, 1) * sizeof(float));
+   int *clip_indices = (int *)malloc(M_MAX(count * (M_RASTER_CLIP_MAX - 2) * 3, 1) * sizeof(int));
+   int clip_count;
+
+   clip_count = m_raster_clip(clip_vertices, clip_attributes, clip_indices, att_comp, width, height, vertices, attributes, vertex_count, indices, count);
+   m__raster_mesh(dest, att_comp, NULL, depth, width, height, clip_vertices, clip_attributes, clip_indices, clip_count);
+
+   free(clip_indices);
+   free(clip_attributes);
+   free(clip_vertices);
+}
+
+/* fill count pixels with a constant color (unrolled per component count) */
+static void m__raster_fill(float *pixel, int count, int comp, const float *color)
+{
+   int i, c;
+   switch (comp) {
+   case 1: {
+      float c0 = color[0];
+      for (i = 0; i < count; i++)
+         pixel[i] = c0;
+      break;
+   }
+   case 2: {
+      float c0 = color[0], c1 = color[1];
+      for (i = 0; i < count; i++, pixel += 2) {
+         pixel[0] = c0; pixel[1] = c1;
+      }
+      break;
+   }
+   case 3: {
+      float c0 = color[0], c1 = color[1], c2 = color[2];
+      for (i = 0; i < count; i++, pixel += 3) {
+         pixel[0] = c0; pixel[1] = c1; pixel[2] = c2;
+      }
+      break;
+   }
+   case 4: {
+      float c0 = color[0], c1 = color[1], c2 = color[2], c3 = color[3];
+      for (i = 0; i < count; i++, pixel += 4) {
+         pixel[0] = c0; pixel[1] = c1; pixel[2] = c2; pixel[3] = c3;
+      }
+      break;
+   }
+   default:
+      for (i = 0; i < count; i++, pixel += comp)
+         for (c = 0; c < comp; c++)
+            pixel[c] = color[c];
+      break;
+   }
+}
+
+/* blend a color over a pixel with a coverage */
+static void m__raster_blend(float *pixel, int comp, const float *color, float a)
+{
+   int c;
+   for (c = 0; c < comp; c++)
+      pixel[c] += (color[c] - pixel[c]) * a;
+}
+
+/* a * b / 255 rounded */
+static unsigned m__raster_mul8(unsigned a, unsigned b)
+{
+   unsigned v = a * b + 128;
+   return (v + (v >> 8)) >> 8;
+}
+
+/* p + (c - p) * a / 255 rounded */
+static unsigned m__raster_lerp8(unsigned p, unsigned c, unsigned a)
+{
+   unsigned v = p * (255 - a) + c * a + 128;
+   return (v + (v >> 8)) >> 8;
+}
+
+/* ubyte RGBA span writers (a: coverage from 0 to 255), one specialized loop per write mode */
+static void m__raster_span_overwrite(unsigned char *pixel, int count, const unsigned char *color, unsigned a)
+{
+   unsigned char c0 = color[0], c1 = color[1], c2 = color[2], c3 = color[3];
+   int i;
+
+   if (a >= 255) {
+      for (i = 0; i < count; i++, pixel += 4) {
+         pixel[0] = c0; pixel[1] = c1; pixel[2] = c2; pixel[3] = c3;
+      }
+   }
+   else if (a > 0) {
+      for (i = 0; i < count; i++, pixel += 4) {
+         pixel[0] = (unsigned char)m__raster_lerp8(pixel[0], c0, a);
+         pixel[1] = (unsigned char)m__raster_lerp8(pixel[1], c1, a);
+         pixel[2] = (unsigned char)m__raster_lerp8(pixel[2], c2, a);
+         pixel[3] = (unsigned char)m__raster_lerp8(pixel[3], c3, a);
+      }
+   }
+}
+
+/* source over (straight alpha) */
+static void m__raster_span_alpha(unsigned char *pixel, int count, const unsigned char *color, unsigned a)
+{
+   unsigned c0 = color[0], c1 = color[1], c2 = color[2];
+   unsigned sa = m__raster_mul8(color[3], a);
+   int i;
+
+   if (sa == 0)
+      return;
+
+   for (i = 0; i < count; i++, pixel += 4) {
+      pixel[0] = (unsigned char)m__raster_lerp8(pixel[0], c0, sa);
+      pixel[1] = (unsigned char)m__raster_lerp8(pixel[1], c1, sa);
+      pixel[2] = (unsigned char)m__raster_lerp8(pixel[2], c2, sa);
+      pixel[3] = (unsigned char)(pixel[3] + m__raster_mul8(255 - pixel[3], sa));
+   }
+}
+
+/* additive (saturated), weighted by the source alpha */
+static void m__raster_span_add(unsigned char *pixel, int count, const unsigned char *color, unsigned a)
+{
+   unsigned sa = m__raster_mul8(color[3], a);
+   unsigned c0 = m__raster_mul8(color[0], sa);
+   unsigned c1 = m__raster_mul8(color[1], sa);
+   unsigned c2 = m__raster_mul8(color[2], sa);
+   int i;
+
+   if (sa == 0)
+      return;
+
+   for (i = 0; i < count; i++, pixel += 4) {
+      pixel[0] = (unsigned char)M_MIN(pixel[0] + c0, 255);
+      pixel[1] = (unsigned char)M_MIN(pixel[1] + c1, 255);
+      pixel[2] = (unsigned char)M_MIN(pixel[2] + c2, 255);
+      pixel[3] = (unsigned char)M_MIN(pixel[3] + sa, 255);
+   }
+}
+
+/* 2d output: float buffer (comp components, overwritten or blended by the coverage)
+   or ubyte RGBA buffer with a write mode,
+   the writers are resolved once per target (no format or mode test per pixel):
+   write: count pixels from (x, y) with the coverage a, put: one fully covered pixel,
+   plot: count pixels (y * width + x offsets) with their own coverage (no clipping) */
+struct m__raster_target
+{
+   float *data;
+   unsigned char *data8;
+   const float *color;
+   unsigned char color8[4];
+   int width, height, comp;
+   void (*write)(const struct m__raster_target *t, int x, int y, int count, float a);
+   void (*put)(const struct m__raster_target *t, int x, int y);
+   void (*plot)(const struct m__raster_target *t, const int *offset, const float *a, int count);
+};
+
+static void m__raster_write_float(const struct m__raster_target *t, int x, int y, int count, float a)
+{
+   float *pixel = t->data + (y * t->width + x) * t->comp;
+   if (a >= 1.0f)
+      m__raster_fill(pixel, count, t->comp, t->color);
+   else {
+      int i;
+      for (i = 0; i < count; i++, pixel += t->comp)
+         m__raster_blend(pixel, t->comp, t->color, a);
+   }
+}
+
+static void m__raster_put_float(const struct m__raster_target *t, int x, int y)
+{
+   float *pixel = t->data + (y * t->width + x) * t->comp;
+   int c;
+   for (c = 0; c < t->comp; c++)
+      pixel[c] = t->color[c];
+}
+
+static void m__raster_plot_float(const struct m__raster_target *t, const int *offset, const float *a, int count)
+{
+   int i;
+   for (i = 0; i < count; i++) {
+      float *pixel = t->data + offset[i] * t->comp;
+      if (a[i] >= 1.0f)
+         m__raster_fill(pixel, 1, t->comp, t->color);
+      else
+         m__raster_blend(pixel, t->comp, t->color, a[i]);
+   }
+}
+
+static void m__raster_write_overwrite8(const struct m__raster_target *t, int x, int y, int count, float a)
+{
+   m__raster_span_overwrite(t->data8 + (y * t->width + x) * 4, count, t->color8, (unsigned)(a * 255.0f + 0.5f));
+}
+
+static void m__raster_put_overwrite8(const struct m__raster_target *t, int x, int y)
+{
+   memcpy(t->data8 + (y * t->width + x) * 4, t->color8, 4);
+}
+
+static void m__raster_plot_overwrite8(const struct m__raster_target *t, const int *offset, const float *a, int count)
+{
+   int i;
+   for (i = 0; i < count; i++)
+      m__raster_span_overwrite(t->data8 + offset[i] * 4, 1, t->color8, (unsigned)(M_MIN(a[i], 1.0f) * 255.0f + 0.5f));
+}
+
+static void m__raster_write_alpha8(const struct m__raster_target *t, int x, int y, int count, float a)
+{
+   m__raster_span_alpha(t->data8 + (y * t->width + x) * 4, count, t->color8, (unsigned)(a * 255.0f + 0.5f));
+}
+
+static void m__raster_put_alpha8(const struct m__raster_target *t, int x, int y)
+{
+   m__raster_span_alpha(t->data8 + (y * t->width + x) * 4, 1, t->color8, 255);
+}
+
+static void m__raster_plot_alpha8(const struct m__raster_target *t, const int *offset, const float *a, int count)
+{
+   int i;
+   for (i = 0; i < count; i++)
+      m__raster_span_alpha(t->data8 + offset[i] * 4, 1, t->color8, (unsigned)(M_MIN(a[i], 1.0f) * 255.0f + 0.5f));
+}
+
+static void m__raster_write_add8(const struct m__raster_target *t, int x, int y, int count, float a)
+{
+   m__raster_span_add(t->data8 + (y * t->width + x) * 4, count, t->color8, (unsigned)(a * 255.0f + 0.5f));
+}
+
+static void m__raster_put_add8(const struct m__raster_target *t, int x, int y)
+{
+   m__raster_span_add(t->data8 + (y * t->width + x) * 4, 1, t->color8, 255);
+}
+
+static void m__raster_plot_add8(const struct m__raster_target *t, const int *offset, const float *a, int count)
+{
+   int i;
+   for (i = 0; i < count; i++)
+      m__raster_span_add(t->data8 + offset[i] * 4, 1, t->color8, (unsigned)(M_MIN(a[i], 1.0f) * 255.0f + 0.5f));
+}
+
+static void m__raster_target_float(struct m__raster_target *t, float *dest, int width, int height, int comp, const float *color)
+{
+   t->data = dest;
+   t->data8 = NULL;
+   t->color = color;
+   t->width = width;
+   t->height = height;
+   t->comp = comp;
+   t->write = m__raster_write_float;
+   t->put = m__raster_put_float;
+   t->plot = m__raster_plot_float;
+}
+
+static void m__raster_target_ubyte(struct m__raster_target *t, unsigned char *dest, int width, int height, const unsigned char *color, int mode)
+{
+   t->data = NULL;
+   t->data8 = dest;
+   t->color = NULL;
+   memcpy(t->color8, color, 4);
+   t->width = width;
+   t->height = height;
+   t->comp = 4;
+
+   switch (mode) {
+   case M_RASTER_ALPHA:
+      t->write = m__raster_write_alpha8;
+      t->put = m__raster_put_alpha8;
+      t->plot = m__raster_plot_alpha8;
+      break;
+   case M_RASTER_ADD:
+      t->write = m__raster_write_add8;
+      t->put = m__raster_put_add8;
+      t->plot = m__raster_plot_add8;
+      break;
+   default:
+      t->write = m__raster_write_overwrite8;
+      t->put = m__raster_put_overwrite8;
+      t->plot = m__raster_plot_overwrite8;
+      break;
+   }
+}
+
+/* clipped span and pixel */
+static void m__raster_span(const struct m__raster_target *t, int x0, int x1, int y, float a)
+{
+   if (y < 0 || y >= t->height)
+      return;
+
+   x0 = M_MAX(x0, 0);
+   x1 = M_MIN(x1, t->width - 1);
+   if (x0 <= x1)
+      t->write(t, x0, y, x1 - x0 + 1, a);
+}
+
+/* anti-aliased pixels are queued and written by batches (one target writer call per batch) */
+#define M_RASTER_PLOT_BATCH 64
+struct m__raster_plots
+{
+   int offset[M_RASTER_PLOT_BATCH];
+   float a[M_RASTER_PLOT_BATCH];
+   int count;
+};
+
+static void m__raster_plot_flush(const struct m__raster_target *t, struct m__raster_plots *q)
+{
+   if (q->count > 0)
+      t->plot(t, q->offset, q->a, q->count);
+   q->count = 0;
+}
+
+static void m__raster_plot(const struct m__raster_target *t, struct m__raster_plots *q, int x, int y, float a)
+{
+   if (x > -1 && y > -1 && x < t->width && y < t->height && a > 0.0f) {
+      q->offset[q->count] = y * t->width + x;
+      q->a[q->count] = a;
+      if (++q->count == M_RASTER_PLOT_BATCH)
+         m__raster_plot_flush(t, q);
+   }
+}
+
+static int64_t m__raster_ceil_div(int64_t n, int64_t d)
+{
+   return n >= 0 ? (n + d - 1) / d : -((-n) / d);
+}
+
+/* visible steps [k0, k1] of a Bresenham line: at step k the major coordinate is c0 + s0 * k
+   and the minor one c1 + s1 * floor((2 * a1 * k + a0) / (2 * a0)),
+   both are monotonic so the visible steps form one interval (Liang-Barsky on the step),
+   return 0 if the line is not visible */
+static int m__raster_line_range(int64_t *k0, int64_t *k1, int64_t a0, int64_t a1, int c0, int s0, int size0, int c1, int s1, int size1)
+{
+   int64_t lo, hi, jlo, jhi;
+
+   /* major axis */
+   lo = s0 > 0 ? -c0 : c0 - (size0 - 1);
+   hi = s0 > 0 ? (size0 - 1) - c0 : c0;
+   lo = M_MAX(lo, 0);
+   hi = M_MIN(hi, a0);
+
+   /* minor axis */
+   jlo = s1 > 0 ? -c1 : c1 - (size1 - 1);
+   jhi = s1 > 0 ? (size1 - 1) - c1 : c1;
+   jlo = M_MAX(jlo, 0);
+   jhi = M_MIN(jhi, a1);
+   if (jlo > jhi)
+      return 0;
+
+   if (a1 > 0) {
+      lo = M_MAX(lo, m__raster_ceil_div(2 * a0 * jlo - a0, 2 * a1));
+      hi = M_MIN(hi, m__raster_ceil_div(2 * a0 * (jhi + 1) - a0, 2 * a1) - 1);
+   }
+
+   *k0 = lo;
+   *k1 = hi;
+   return lo <= hi;
+}
+
+static void m__raster_line(const struct m__raster_target *t, float *p0, float *p1)
+{
+   int x0 = (int)p0[0];
+   int y0 = (int)p0[1];
+   int x1 = (int)p1[0];
+   int y1 = (int)p1[1];
+   int w = t->width;
+   int h = t->height;
+   int dx =  M_ABS(x1 - x0), sx = x0 < x1 ? 1 : -1;
+   int dy = -M_ABS(y1 - y0), sy = y0 < y1 ? 1 : -1;
+   int64_t ax = dx, ay = -dy;
+   int64_t i, j, k0, k1, n;
+   int err, e2;
+
+   /* clip once, every remaining pixel is inside */
+   if (ax >= ay) {
+      if (! m__raster_line_range(&k0, &k1, ax, ay, x0, sx, w, y0, sy, h))
+         return;
+      i = k0;
+      j = ax > 0 ? (2 * ay * k0 + ax) / (2 * ax) : 0;
+   }
+   else {
+      if (! m__raster_line_range(&k0, &k1, ay, ax, y0, sy, h, x0, sx, w))
+         return;
+      j = k0;
+      i = (2 * ax * k0 + ay) / (2 * ay);
+   }
+
+   /* Bresenham state at the first visible step */
+   x0 += (int)(sx * i);
+   y0 += (int)(sy * j);
+   err = (int)((ax - ay) + ax * j - ay * i);
+
+   /* float: the pixel is written in place and stepped with the error term,
+      one loop per component count (the color stays in registers) */
+   #define M_LINE_LOOP(STORE)\
+   for (n = k0; n <= k1; n++) {\
+      STORE\
+      e2 = 2 * err;\
+      if (e2 >= dy) { err += dy; pixel += step_x; }\
+      if (e2 <= dx) { err += dx; pixel += step_y; }\
+   }
+
+   if (t->data) {
+
+      const float *color = t->color;
+      int comp = t->comp;
+      int step_x = sx * comp;
+      int step_y = sy * w * comp;
+      float *pixel = t->data + (y0 * w + x0) * comp;
+
+      switch (comp) {
+      case 1: {
+         float c0 = color[0];
+         M_LINE_LOOP(pixel[0] = c0;)
+         break;
+      }
+      case 2: {
+         float c0 = color[0], c1 = color[1];
+         M_LINE_LOOP(pixel[0] = c0; pixel[1] = c1;)
+         break;
+      }
+      case 3: {
+         float c0 = color[0], c1 = color[1], c2 = color[2];
+         M_LINE_LOOP(pixel[0] = c0; pixel[1] = c1; pixel[2] = c2;)
+         break;
+      }
+      case 4: {
+         float c0 = color[0], c1 = color[1], c2 = color[2], c3 = color[3];
+         M_LINE_LOOP(pixel[0] = c0; pixel[1] = c1; pixel[2] = c2; pixel[3] = c3;)
+         break;
+      }
+      default:
+         M_LINE_LOOP({ int c; for (c = 0; c < comp; c++) pixel[c] = color[c]; })
+         break;
+      }
+      return;
+   }
+
+   #undef M_LINE_LOOP
+
+   for (n = k0; n <= k1; n++) {
+
+      t->put(t, x0, y0);
+
+      e2 = 2 * err;
+      if (e2 >= dy) { err += dy; x0 += sx; }
+      if (e2 <= dx) { err += dx; y0 += sy; }
+   }
+}
+
+/* convex polygon filled with horizontal spans (pixels are sampled at integer coordinates) */
+static void m__raster_convex(const struct m__raster_target *t, const float *points, int count)
+{
+   float miny, maxy, area = 0.0f;
+   int i, y, y0, y1;
+
+   miny = maxy = points[1];
+   for (i = 0; i < count; i++) {
+      const float *a = points + i * 2;
+      const float *b = points + ((i + 1) % count) * 2;
+      area += a[0] * b[1] - b[0] * a[1];
+      miny = M_MIN(miny, a[1]);
+      maxy = M_MAX(maxy, a[1]);
+   }
+
+   if (area == 0.0f)
+      return;
+
+   y0 = (int)M_MAX(ceilf(miny), 0.0f);
+   y1 = (int)M_MIN(floorf(maxy), (float)(t->height - 1));
+
+   for (y = y0; y <= y1; y++) {
+
+      float xmin = 0.0f;
+      float xmax = (float)(t->width - 1);
+
+      /* intersect the row with the inner side of each edge */
+      for (i = 0; i < count; i++) {
+         const float *a = points + i * 2;
+         const float *b = points + ((i + 1) % count) * 2;
+         float ex = b[0] - a[0];
+         float ey = b[1] - a[1];
+         float k = area > 0.0f ? -ey : ey;
+         float m = ex * ((float)y - a[1]) + ey * a[0];
+         if (area < 0.0f) m = -m;
+
+         if (k > 0.0f)
+            xmin = M_MAX(xmin, -m / k);
+         else if (k < 0.0f)
+            xmax = M_MIN(xmax, -m / k);
+         else if (m < 0.0f)
+            xmax = -1.0f;
+      }
+
+      if (xmin <= xmax)
+         m__raster_span(t, (int)ceilf(xmin), (int)floorf(xmax), y, 1.0f);
+   }
+}
+
+static void m__raster_line_thick(const struct m__raster_target *t, float *p0, float *p1, float thickness)
+{
+   float quad[8];
+   float dx = p1[0] - p0[0];
+   float dy = p1[1] - p0[1];
+   float len = sqrtf(dx * dx + dy * dy);
+   float r = thickness * 0.5f;
+   float ex, ey, nx, ny;
+
+   if (len > 0.0f) {
+      ex = dx * (r / len);
+      ey = dy * (r / len);
+   }
+   else {
+      ex = r;
+      ey = 0.0f;
+   }
+
+   /* square caps */
+   nx = -ey;
+   ny = ex;
+   quad[0] = p0[0] - ex + nx; quad[1] = p0[1] - ey + ny;
+   quad[2] = p1[0] + ex + nx; quad[3] = p1[1] + ey + ny;
+   quad[4] = p1[0] + ex - nx; quad[5] = p1[1] + ey - ny;
+   quad[6] = p0[0] - ex - nx; quad[7] = p0[1] - ey - ny;
+
+   m__raster_convex(t, quad, 4);
+}
+
+// Midpoint Circle Algorithm : http://en[3]ikipedia.org/wiki/Midpoint_circle_algorithm
+static void m__raster_circle(const struct m__raster_target *t, float *p, float r)
+{
+   /* float pixels are written in place */
+   #define M_CIRCLE_PIXEL(px, py)\
+   if (data) {\
+      float *pixel = data + ((py) * w + (px)) * comp; int c;\
+      for (c = 0; c < comp; c++)\
+         pixel[c] = color[c];\
+   }\
+   else\
+      t->put(t, px, py);
+
+   /* one row of the 8 octants: the row is tested once, then the 2 columns */
+   #define M_CIRCLE_ROW(py, dx)\
+   if (inside) {\
+      M_CIRCLE_PIXEL(x0 + (dx), py)\
+      M_CIRCLE_PIXEL(x0 - (dx), py)\
+   }\
+   else if ((py) > -1 && (py) < h) {\
+      if (x0 + (dx) > -1 && x0 + (dx) < w) { M_CIRCLE_PIXEL(x0 + (dx), py) }\
+      if (x0 - (dx) > -1 && x0 - (dx) < w) { M_CIRCLE_PIXEL(x0 - (dx), py) }\
+   }
+
+   float *data = t->data;
+   const float *color = t->color;
+   int comp = t->comp;
+   int x0 = (int)p[0];
+   int y0 = (int)p[1];
+   int radius = (int)r;
+   int w = t->width;
+   int h = t->height;
+   int x = radius, y = 0;
+   int radius_error = 1 - x;
+   int inside;
+
+   /* outside */
+   if (radius < 0 || x0 + radius < 0 || y0 + radius < 0 || x0 - radius >= w || y0 - radius >= h)
+      return;
+
+   inside = (x0 - radius >= 0 && y0 - radius >= 0 && x0 + radius < w && y0 + radius < h);
+ 
+   while (x >= y) {
+
+      M_CIRCLE_ROW(y0 + y, x)
+      M_CIRCLE_ROW(y0 - y, x)
+      M_CIRCLE_ROW(y0 + x, y)
+      M_CIRCLE_ROW(y0 - x, y)
+      y++;
+        
+      if (radius_error < 0)
+         radius_error += 2 * y + 1;
+      else {
+         x--;
+         radius_error += 2 * (y - x + 1);
+      }
+   }
+
+   #undef M_CIRCLE_ROW
+   #undef M_CIRCLE_PIXEL
+}
+
+/* same midpoint circle, one span per row */
+static void m__raster_circle_fill(const struct m__raster_target *t, float *p, float r)
+{
+   int x0 = (int)p[0];
+   int y0 = (int)p[1];
+   int radius = (int)r;
+   int x = radius, y = 0;
+   int radius_error = 1 - x;
+
+   if (radius < 0 || x0 + radius < 0 || y0 + radius < 0 || x0 - radius >= t->width || y0 - radius >= t->height)
+      return;
+
+   while (x >= y) {
+
+      /* rows y0 +/- y */
+      m__raster_span(t, x0 - x, x0 + x, y0 + y, 1.0f);
+      if (y > 0)
+         m__raster_span(t, x0 - x, x0 + x, y0 - y, 1.0f);
+      y++;
+
+      if (radius_error < 0)
+         radius_error += 2 * y + 1;
+      else {
+         /* rows y0 +/- x are complete when x changes */
+         if (x >= y) {
+            m__raster_span(t, x0 - y + 1, x0 + y - 1, y0 + x, 1.0f);
+            m__raster_span(t, x0 - y + 1, x0 + y - 1, y0 - x, 1.0f);
+         }
+         x--;
+         radius_error += 2 * (y - x + 1);
+      }
+   }
+}
+
+/* polygon edge, active on the sample rows [y0, y1) */
+struct m__raster_edge
+{
+   float x, dxdy;
+   int y0, y1;
+   int dir;
+};
+
+/* add the horizontal coverage of [x0, x1) to a row (pixel i covers [i - 0.5, i + 0.5)) */
+static void m__raster_cover(float *cov, int width, float x0, float x1, float weight)
+{
+   int i0, i1, i;
+
+   x0 = M_MAX(x0 + 0.5f, 0.0f);
+   x1 = M_MIN(x1 + 0.5f, (float)width);
+   if (x1 <= x0)
+      return;
+
+   i0 = (int)x0;
+   i1 = (int)x1;
+
+   if (i0 == i1) {
+      cov[i0] += (x1 - x0) * weight;
+      return;
+   }
+
+   cov[i0] += ((float)(i0 + 1) - x0) * weight;
+   for (i = i0 + 1; i < i1; i++)
+      cov[i] += weight;
+   if (i1 < width)
+      cov[i1] += (x1 - (float)i1) * weight;
+}
+
+static void m__raster_polygons(const struct m__raster_target *t, float *points, int *counts, int polygon_count, int rule, int aa)
+{
+   struct m__raster_edge *edges;
+   float *cov = NULL;
+   float *point = points;
+   int *offsets, *bucket, *active;
+   int width = t->width;
+   int height = t->height;
+   int sub = aa ? M_RASTER_AA_SUB : 1;
+   int mask = rule == M_RASTER_NON_ZERO ? ~0 : 1;
+   int rows = height * sub;
+   int edge_count = 0, active_count = 0;
+   int ymin = rows, ymax = 0;
+   int i, p, sy;
+
+   if (width <= 0 || height <= 0)
+      return;
+
+   for (p = 0, i = 0; p < polygon_count; p++)
+      i += counts[p];
+
+   edges = (struct m__raster_edge *)malloc(M_MAX(i, 1) * sizeof(struct m__raster_edge));
+   offsets = (int *)calloc(rows + 1, sizeof(int));
+
+   /* edge table (in sub-scanline units) */
+   for (p = 0; p < polygon_count; p++) {
+
+      int count = counts[p];
+
+      for (i = 0; i < count; i++) {
+
+         struct m__raster_edge *edge = edges + edge_count;
+         float *a = point + i * 2;
+         float *b = point + ((i + 1) % count) * 2;
+         float ya = (a[1] + 0.5f) * sub - 0.5f;
+         float yb = (b[1] + 0.5f) * sub - 0.5f;
+         float *top = a, *bot = b;
+         float yt = ya, yd = yb;
+
+         if (ya == yb)
+            continue;
+
+         edge->dir = 1;
+         if (ya > yb) {
+            top = b; bot = a;
+            yt = yb; yd = ya;
+            edge->dir = -1;
+         }
+
+         edge->y0 = (int)M_MAX(ceilf(yt), 0.0f);
+         edge->y1 = (int)M_MIN(ceilf(yd), (float)rows);
+         if (edge->y0 >= edge->y1)
+            continue;
+
+         edge->dxdy = (bot[0] - top[0]) / (yd - yt);
+         edge->x = top[0] + ((float)edge->y0 - yt) * edge->dxdy;
+
+         ymin = M_MIN(ymin, edge->y0);
+         ymax = M_MAX(ymax, edge->y1);
+         offsets[edge->y0 + 1]++;
+         edge_count++;
+      }
+
+      point += count * 2;
+   }
+
+   /* sort the edges by first row (counting sort) */
+   for (i = 0; i < rows; i++)
+      offsets[i + 1] += offsets[i];
+
+   bucket = (int *)malloc(M_MAX(edge_count, 1) * sizeof(int));
+   active = (int *)malloc(M_MAX(edge_count, 1) * sizeof(int));
+   for (i = 0; i < edge_count; i++)
+      bucket[offsets[edges[i].y0]++] = i;
+   for (i = rows; i > 0; i--)
+      offsets[i] = offsets[i - 1];
+   offsets[0] = 0;
+
+   if (aa)
+      cov = (float *)calloc(width, sizeof(float));
+
+   /* scanlines */
+   for (sy = ymin; sy < ymax; sy++) {
+
+      int winding = 0;
+      float xl = 0.0f;
+      int n = 0;
+
+      /* remove the finished edges and add the starting ones */
+      for (i = 0; i < active_count; i++) {
+         if (edges[active[i]].y1 > sy)
+            active[n++] = active[i];
+      }
+      active_count = n;
+
+      for (i = offsets[sy]; i < offsets[sy + 1]; i++)
+         active[active_count++] = bucket[i];
+
+      /* keep the active edges sorted by x (insertion sort, almost sorted) */
+      for (i = 1; i < active_count; i++) {
+         int e = active[i];
+         float x = edges[e].x;
+         int j = i - 1;
+         while (j >= 0 && edges[active[j]].x > x) {
+            active[j + 1] = active[j];
+            j--;
+         }
+         active[j + 1] = e;
+      }
+
+      /* spans (even-odd or nonzero winding) */
+      for (i = 0; i < active_count; i++) {
+
+         struct m__raster_edge *edge = edges + active[i];
+         int inside = (winding & mask) != 0;
+
+         winding += rule == M_RASTER_NON_ZERO ? edge->dir : 1;
+
+         if (! inside && (winding & mask))
+            xl = edge->x;
+         else if (inside && !(winding & mask)) {
+            if (aa)
+               m__raster_cover(cov, width, xl, edge->x, 1.0f / sub);
+            else {
+               int x0 = (int)ceilf(M_MAX(xl, -1.0f));
+               int x1 = (int)ceilf(M_MIN(edge->x, (float)width)) - 1;
+               m__raster_span(t, x0, x1, sy, 1.0f);
+            }
+         }
+
+         edge->x += edge->dxdy;
+      }
+
+      /* blend the coverage of the completed row */
+      if (aa && (sy % sub == sub - 1 || sy == ymax - 1)) {
+         int x = 0;
+         while (x < width) {
+            float c = cov[x];
+            int x0 = x;
+            /* runs of equal coverage */
+            while (x < width && cov[x] == c)
+               cov[x++] = 0.0f;
+            if (c > 0.0f)
+               t->write(t, x0, sy / sub, x - x0, M_MIN(c, 1.0f));
+         }
+      }
+   }
+
+   free(cov);
+   free(active);
+   free(bucket);
+   free(offsets);
+   free(edges);
+}
+
+
+/* Xiaolin Wu's line, the major axis is clipped up front */
+static void m__raster_line_aa(const struct m__raster_target *t, float *p0, float *p1)
+{
+   #define M_WU_PLOT(px, py, a)\
+   if (steep) m__raster_plot(t, &q, py, px, a);\
+   else       m__raster_plot(t, &q, px, py, a);
+
+   struct m__raster_plots q;
+   float x0 = p0[0], y0 = p0[1];
+   float x1 = p1[0], y1 = p1[1];
+   float dx, dy, gradient, intery;
+   float xend, yend, xgap;
+   int steep = fabsf(y1 - y0) > fabsf(x1 - x0);
+   int size = steep ? t->height : t->width;
+   int xpxl1, xpxl2, ypxl, xa, xb, x;
+
+   q.count = 0;
+
+   if (steep) {
+      float tmp;
+      tmp = x0; x0 = y0; y0 = tmp;
+      tmp = x1; x1 = y1; y1 = tmp;
+   }
+   if (x0 > x1) {
+      float tmp;
+      tmp = x0; x0 = x1; x1 = tmp;
+      tmp = y0; y0 = y1; y1 = tmp;
+   }
+
+   /* outside */
+   if (x1 < -1.0f || x0 > (float)size)
+      return;
+
+   dx = x1 - x0;
+   dy = y1 - y0;
+   gradient = dx == 0.0f ? 1.0f : dy / dx;
+
+   /* first end point */
+   xend = floorf(x0 + 0.5f);
+   yend = y0 + gradient * (xend - x0);
+   xgap = 1.0f - (x0 + 0.5f - floorf(x0 + 0.5f));
+   xpxl1 = (int)xend;
+   ypxl = (int)floorf(yend);
+   M_WU_PLOT(xpxl1, ypxl, (1.0f - (yend - floorf(yend))) * xgap)
+   M_WU_PLOT(xpxl1, ypxl + 1, (yend - floorf(yend)) * xgap)
+   intery = yend + gradient;
+
+   /* second end point */
+   xend = floorf(x1 + 0.5f);
+   yend = y1 + gradient * (xend - x1);
+   xgap = x1 + 0.5f - floorf(x1 + 0.5f);
+   xpxl2 = (int)xend;
+   ypxl = (int)floorf(yend);
+   M_WU_PLOT(xpxl2, ypxl, (1.0f - (yend - floorf(yend))) * xgap)
+   M_WU_PLOT(xpxl2, ypxl + 1, (yend - floorf(yend)) * xgap)
+
+   /* visible part of the main loop */
+   xa = M_MAX(xpxl1 + 1, 0);
+   xb = M_MIN(xpxl2 - 1, size - 1);
+   intery += gradient * (float)(xa - (xpxl1 + 1));
+
+   for (x = xa; x <= xb; x++) {
+      float fy = floorf(intery);
+      int iy = (int)fy;
+      M_WU_PLOT(x, iy, 1.0f - (intery - fy))
+      M_WU_PLOT(x, iy + 1, intery - fy)
+      intery += gradient;
+   }
+
+   m__raster_plot_flush(t, &q);
+
+   #undef M_WU_PLOT
+}
+
+/* anti-aliased circle from its distance field: 1 pixel wide ring or disk,
+   only the rows and the pixel ranges close to the edge are evaluated */
+static void m__raster_circle_aa(const struct m__raster_target *t, float *p, float r, int fill)
+{
+   struct m__raster_plots q;
+   float cx = p[0];
+   float cy = p[1];
+   float hw = fill ? 0.5f : 1.0f; /* half width of the edge coverage */
+   float ro = r + hw;
+   float ri = r - hw;
+   int y0 = (int)M_MAX(ceilf(cy - ro), 0.0f);
+   int y1 = (int)M_MIN(floorf(cy + ro), (float)(t->height - 1));
+   int y;
+
+   if (r < 0.0f)
+      return;
+
+   q.count = 0;
+
+   for (y = y0; y <= y1; y++) {
+
+      float dy = (float)y - cy;
+      float ho = sqrtf(M_MAX(ro * ro - dy * dy, 0.0f));
+      float hi = ri > 0.0f ? sqrtf(M_MAX(ri * ri - dy * dy, 0.0f)) : 0.0f;
+      int xo0 = (int)ceilf(cx - ho);
+      int xo1 = (int)floorf(cx + ho);
+      int xi0 = (int)floorf(cx - hi);
+      int xi1 = (int)ceilf(cx + hi);
+      int x;
+
+      if (hi <= 0.0f) {
+         /* the row only crosses the edge */
+         xi0 = xo1;
+         xi1 = xo1 + 1;
+      }
+      else if (fill) {
+         /* fully covered interior */
+         m__raster_span(t, xi0 + 1, xi1 - 1, y, 1.0f);
+      }
+
+      xo0 = M_MAX(xo0, 0);
+      xo1 = M_MIN(xo1, t->width - 1);
+
+      /* left and right edge pixels */
+      for (x = xo0; x <= M_MIN(xi0, xo1); x++) {
+         float dx = (float)x - cx;
+         float d = sqrtf(dx * dx + dy * dy) - r;
+         float a = fill ? 0.5f - d : 1.0f - fabsf(d);
+         m__raster_plot(t, &q, x, y, a);
+      }
+      for (x = M_MAX(xi1, M_MAX(xi0 + 1, xo0)); x <= xo1; x++) {
+         float dx = (float)x - cx;
+         float d = sqrtf(dx * dx + dy * dy) - r;
+         float a = fill ? 0.5f - d : 1.0f - fabsf(d);
+         m__raster_plot(t, &q, x, y, a);
+      }
+   }
+
+   m__raster_plot_flush(t, &q);
+}
+
+/* signed area of the line (x0, y0) (x1, y1) accumulated in the cells of each row it crosses
+   (x and y in cell units, cell i covers [i, i + 1)) */
+static void m__raster_accumulate_line(float *acc, int width, int height, float x0, float y0, float x1, float y1)
+{
+   #define M_ACC(i, v) if ((i) < width) row[i] += (v);
+
+   float w = (float)width;
+   float dir, dxdy, x;
+   int y, ys, ye;
+
+   if (y0 == y1)
+      return;
+
+   dir = 1.0f;
+   if (y0 > y1) {
+      float tmp;
+      dir = -1.0f;
+      tmp = x0; x0 = x1; x1 = tmp;
+      tmp = y0; y0 = y1; y1 = tmp;
+   }
+
+   dxdy = (x1 - x0) / (y1 - y0);
+
+   /* clip to the rows */
+   if (y0 < 0.0f) {
+      x0 -= y0 * dxdy;
+      y0 = 0.0f;
+   }
+   y1 = M_MIN(y1, (float)height);
+   if (y0 >= y1)
+      return;
+
+   /* the end points are inside [0, width], the clamps only absorb the rounding
+      of the row clipping and stepping (a cell index of -1 would write before the row) */
+   x = M_MIN(M_MAX(x0, 0.0f), w);
+   ys = (int)y0;
+   ye = (int)ceilf(y1);
+
+   for (y = ys; y < ye; y++) {
+
+      float *row = acc + y * width;
+      float dy = M_MIN((float)(y + 1), y1) - M_MAX((float)y, y0);
+      float xnext = M_MIN(M_MAX(x + dxdy * dy, 0.0f), w);
+      float d = dy * dir;
+      float xa = M_MIN(x, xnext);
+      float xb = M_MAX(x, xnext);
+      float xa_floor = floorf(xa);
+      int xa_i = (int)xa_floor;
+      int xb_i = (int)ceilf(xb);
+
+      if (xb_i <= xa_i + 1) {
+         /* inside one cell */
+         float xmf = 0.5f * (x + xnext) - xa_floor;
+         M_ACC(xa_i, d - d * xmf)
+         M_ACC(xa_i + 1, d * xmf)
+      }
+      else {
+         float s = 1.0f / (xb - xa);
+         float xa_f = xa - xa_floor;
+         float a0 = 0.5f * s * (1.0f - xa_f) * (1.0f - xa_f);
+         float xb_f = xb - (float)xb_i + 1.0f;
+         float am = 0.5f * s * xb_f * xb_f;
+         int i;
+
+         M_ACC(xa_i, d * a0)
+         if (xb_i == xa_i + 2) {
+            M_ACC(xa_i + 1, d * (1.0f - a0 - am))
+         }
+         else {
+            float a1 = s * (1.5f - xa_f);
+            float a2 = a1 + (float)(xb_i - xa_i - 3) * s;
+            M_ACC(xa_i + 1, d * (a1 - a0))
+            for (i = xa_i + 2; i < M_MIN(xb_i - 1, width); i++)
+               row[i] += d * s;
+            M_ACC(xb_i - 1, d * (1.0f - a2 - am))
+         }
+         M_ACC(xb_i, d * am)
+      }
+
+      x = xnext;
+   }
+
+   #undef M_ACC
+}
+
+MRAPI void m_raster_coverage_polygons(float *acc, int width, int height, float *points, int *counts, int polygon_count)
+{
+   float *point = points;
+   float w = (float)width;
+   int p, i;
+
+   for (p = 0; p < polygon_count; p++) {
+
+      int count = counts[p];
+
+      for (i = 0; i < count; i++) {
+
+         float *a = point + i * 2;
+         float *b = point + ((i + 1) % count) * 2;
+         float x0 = a[0] + 0.5f, y0 = a[1] + 0.5f; /* pixel centers to cells */
+         float x1 = b[0] + 0.5f, y1 = b[1] + 0.5f;
+         float t[4];
+         int n = 0, k;
+
+         /* split at x = 0 and x = width, the parts outside are projected on the borders
+            (left: they cover the whole row, right: they cover nothing visible) */
+         t[n++] = 0.0f;
+         if ((x0 < 0.0f) != (x1 < 0.0f)) t[n++] = x0 / (x0 - x1);
+         if ((x0 < w) != (x1 < w)) t[n++] = (x0 - w) / (x0 - x1);
+         if (n == 3 && t[1] > t[2]) { float tmp = t[1]; t[1] = t[2]; t[2] = tmp; }
+         t[n++] = 1.0f;
+
+         for (k = 0; k < n - 1; k++) {
+            float xa = x0 + (x1 - x0) * t[k];
+            float ya = y0 + (y1 - y0) * t[k];
+            float xb = x0 + (x1 - x0) * t[k + 1];
+            float yb = y0 + (y1 - y0) * t[k + 1];
+            float xm = 0.5f * (xa + xb);
+            if (xm < 0.0f)
+               xa = xb = 0.0f;
+            else if (xm > w)
+               xa = xb = w;
+            else {
+               xa = M_MIN(M_MAX(xa, 0.0f), w);
+               xb = M_MIN(M_MAX(xb, 0.0f), w);
+            }
+            m__raster_accumulate_line(acc, width, height, xa, ya, xb, yb);
+         }
+      }
+
+      point += count * 2;
+   }
+}
+
+static void m__raster_coverage_resolve(const struct m__raster_target *t, float *acc)
+{
+   int width = t->width;
+   int y;
+
+   #pragma omp parallel for schedule(dynamic, 8)
+   for (y = 0; y < t->height; y++) {
+
+      float *row = acc + y * width;
+      float sum = 0.0f;
+      int x = 0;
+
+      /* prefix sum of the signed areas, the coverage only changes on accumulated cells */
+      while (x < width) {
+
+         int x0 = x;
+         float a;
+
+         sum += row[x];
+         row[x++] = 0.0f;
+         while (x < width && row[x] == 0.0f)
+            x++;
+
+         a = M_MIN(fabsf(sum), 1.0f);
+         if (a > 0.0f)
+            t->write(t, x0, y, x - x0, a);
+      }
+   }
+}
+
+MRAPI void m_raster_span(float *dest, int width, int height, int comp, int x0, int x1, int y, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   m__raster_span(&t, x0, x1, y, 1.0f);
+}
+
+MRAPI void m_raster_line(float *dest, int width, int height, int comp, float *p0, float *p1, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   m__raster_line(&t, p0, p1);
+}
+
+MRAPI void m_raster_line_thick(float *dest, int width, int height, int comp, float *p0, float *p1, float thickness, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   m__raster_line_thick(&t, p0, p1, thickness);
+}
+
+MRAPI void m_raster_circle(float *dest, int width, int height, int comp, float *p, float r, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   m__raster_circle(&t, p, r);
+}
+
+MRAPI void m_raster_circle_fill(float *dest, int width, int height, int comp, float *p, float r, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   m__raster_circle_fill(&t, p, r);
+}
+
+MRAPI void m_raster_polygon(float *dest, int width, int height, int comp, float *points, int count, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   if (count >= 3)
+      m__raster_polygons(&t, points, &count, 1, M_RASTER_EVEN_ODD, 0);
+}
+
+MRAPI void m_raster_polygons(float *dest, int width, int height, int comp, float *points, int *counts, int polygon_count, int rule, int aa, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   m__raster_polygons(&t, points, counts, polygon_count, rule, aa);
+}
+
+MRAPI void m_raster_line_aa(float *dest, int width, int height, int comp, float *p0, float *p1, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   m__raster_line_aa(&t, p0, p1);
+}
+
+MRAPI void m_raster_circle_aa(float *dest, int width, int height, int comp, float *p, float r, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   m__raster_circle_aa(&t, p, r, 0);
+}
+
+MRAPI void m_raster_circle_fill_aa(float *dest, int width, int height, int comp, float *p, float r, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   m__raster_circle_aa(&t, p, r, 1);
+}
+
+MRAPI void m_raster_coverage_resolve(float *dest, int width, int height, int comp, float *acc, float *color)
+{
+   struct m__raster_target t;
+   m__raster_target_float(&t, dest, width, height, comp, color);
+   m__raster_coverage_resolve(&t, acc);
+}
+
+MRAPI void m_raster_span_ubyte(unsigned char *dest, int width, int height, int x0, int x1, int y, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   m__raster_span(&t, x0, x1, y, 1.0f);
+}
+
+MRAPI void m_raster_line_ubyte(unsigned char *dest, int width, int height, float *p0, float *p1, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   m__raster_line(&t, p0, p1);
+}
+
+MRAPI void m_raster_line_thick_ubyte(unsigned char *dest, int width, int height, float *p0, float *p1, float thickness, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   m__raster_line_thick(&t, p0, p1, thickness);
+}
+
+MRAPI void m_raster_circle_ubyte(unsigned char *dest, int width, int height, float *p, float r, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   m__raster_circle(&t, p, r);
+}
+
+MRAPI void m_raster_circle_fill_ubyte(unsigned char *dest, int width, int height, float *p, float r, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   m__raster_circle_fill(&t, p, r);
+}
+
+MRAPI void m_raster_polygon_ubyte(unsigned char *dest, int width, int height, float *points, int count, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   if (count >= 3)
+      m__raster_polygons(&t, points, &count, 1, M_RASTER_EVEN_ODD, 0);
+}
+
+MRAPI void m_raster_polygons_ubyte(unsigned char *dest, int width, int height, float *points, int *counts, int polygon_count, int rule, int aa, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   m__raster_polygons(&t, points, counts, polygon_count, rule, aa);
+}
+
+MRAPI void m_raster_line_aa_ubyte(unsigned char *dest, int width, int height, float *p0, float *p1, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   m__raster_line_aa(&t, p0, p1);
+}
+
+MRAPI void m_raster_circle_aa_ubyte(unsigned char *dest, int width, int height, float *p, float r, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   m__raster_circle_aa(&t, p, r, 0);
+}
+
+MRAPI void m_raster_circle_fill_aa_ubyte(unsigned char *dest, int width, int height, float *p, float r, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   m__raster_circle_aa(&t, p, r, 1);
+}
+
+MRAPI void m_raster_coverage_resolve_ubyte(unsigned char *dest, int width, int height, float *acc, const unsigned char *color, int mode)
+{
+   struct m__raster_target t;
+   m__raster_target_ubyte(&t, dest, width, height, color, mode);
+   m__raster_coverage_resolve(&t, acc);
 }
 
 #endif /* M_RASTER_IMPLEMENTATION */
\ No newline at end of file
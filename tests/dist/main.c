@@ -0,0 +1,222 @@
+/*======================================================================
+    Maratis Tiny C Library
+    version 1.0
+------------------------------------------------------------------------
+    Copyright (c) 2016 Anael Seghezzi <www.maratis3d.com>
+
+    This software is provided 'as-is', without any express or implied
+    warranty. In no event will the authors be held liable for any damages
+    arising from the use of this software.
+
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would
+    be appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not
+    be misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution.
+
+========================================================================*/
+
+/* signed distance field test against the exact distance to known edges,
+   jump flooding voronoi test against the exact transform */
+
+#define M_DIST_IMPLEMENTATION
+#include <m_dist.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#define W 96
+#define H 96
+#define SUB 16
+#define MARGIN 12
+#define RANGE 10.0f
+
+static float mask[W * H];
+static float sdf[W * H];
+static float ref[W * H];
+static float seeds[W * H];
+static float dist_exact[W * H];
+static float dist_jfa[W * H];
+static int index_map[W * H];
+static int seed_list[W * H];
+static int failed = 0;
+
+
+/* exact coverage of pixel (x, y) by the half-plane nx * px + ny * py < c */
+static float cover_half_plane(int x, int y, float nx, float ny, float c)
+{
+	float px[8], py[8];
+	float sx[4] = {0, 1, 1, 0};
+	float sy[4] = {0, 0, 1, 1};
+	float area = 0;
+	int i, n = 0;
+
+	for (i = 0; i < 4; i++) {
+		int j = (i + 1) % 4;
+		float di = nx * (x + sx[i]) + ny * (y + sy[i]) - c;
+		float dj = nx * (x + sx[j]) + ny * (y + sy[j]) - c;
+		if (di < 0) {
+			px[n] = x + sx[i];
+			py[n++] = y + sy[i];
+		}
+		if ((di < 0) != (dj < 0)) {
+			float t = di / (di - dj);
+			px[n] = x + sx[i] + t * (sx[j] - sx[i]);
+			py[n++] = y + sy[i] + t * (sy[j] - sy[i]);
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		int j = (i + 1) % n;
+		area += px[i] * py[j] - px[j] * py[i];
+	}
+	return (float)fabs(area) * 0.5f;
+}
+
+/* supersampled coverage of pixel (x, y) by a disc */
+static float cover_disc(int x, int y, float cx, float cy, float r)
+{
+	int i, j, n = 0;
+	for (j = 0; j < SUB; j++)
+	for (i = 0; i < SUB; i++) {
+		float dx = x + (i + 0.5f) / SUB - cx;
+		float dy = y + (j + 0.5f) / SUB - cy;
+		n += (dx * dx + dy * dy) < r * r;
+	}
+	return (float)n / (SUB * SUB);
+}
+
+/* compares the transform of mask to ref near the edge, away from the image borders */
+static void check(const char *name, float tolerance)
+{
+	float err = 0;
+	int x, y;
+
+	m_signed_dist_transform_2d(sdf, mask, W, H);
+
+	for (y = MARGIN; y < H - MARGIN; y++)
+	for (x = MARGIN; x < W - MARGIN; x++) {
+		int i = y * W + x;
+		if (fabs(ref[i]) < RANGE)
+			err = M_MAX(err, (float)fabs(sdf[i] - ref[i]));
+	}
+
+	printf("%-32s max error: %.4f %s\n", name, err, err <= tolerance ? "ok" : "FAILED");
+	if (err > tolerance)
+		failed = 1;
+}
+
+/* jump flooding against a brute-force voronoi (random seeds of equal value):
+   the refined result must be exact, the returned correction must bound
+   (and match) the error of the unrefined result, -1 without refinement */
+static void check_jfa(int density)
+{
+	float err = 0, err_ref = 0, ret0, ret;
+	int count = 0;
+	int i, j;
+
+	for (i = 0; i < W * H; i++) {
+		seeds[i] = (rand() % 1000) < density ? 0 : M_DIST_MAX;
+		if (seeds[i] == 0)
+			seed_list[count++] = i;
+	}
+
+	for (i = 0; i < W * H; i++) {
+		float d = M_DIST_MAX;
+		for (j = 0; j < count; j++) {
+			float dx = (float)(i % W - seed_list[j] % W);
+			float dy = (float)(i / W - seed_list[j] / W);
+			d = M_MIN(d, dx * dx + dy * dy);
+		}
+		dist_exact[i] = d;
+	}
+
+	ret0 = m_voronoi_transform_2d_jfa(dist_jfa, index_map, seeds, W, H, 0);
+	for (i = 0; i < W * H; i++)
+		err = M_MAX(err, sqrtf(dist_jfa[i]) - sqrtf(dist_exact[i]));
+
+	ret = m_voronoi_transform_2d_jfa(dist_jfa, index_map, seeds, W, H, 1);
+	for (i = 0; i < W * H; i++)
+		err_ref = M_MAX(err_ref, (float)fabs(sqrtf(dist_jfa[i]) - sqrtf(dist_exact[i])));
+
+	printf("jfa density %-4d error %.4f refined %.4f (returned %.4f, %.0f unrefined) %s\n", density, err, err_ref, ret, ret0,
+		(err_ref < 0.0001f && err <= ret + 0.0001f && fabs(ret - err) < 0.0001f && ret0 == -1) ? "ok" : "FAILED");
+	if (err_ref >= 0.0001f || err > ret + 0.0001f || fabs(ret - err) >= 0.0001f || ret0 != -1)
+		failed = 1;
+}
+
+int main(void)
+{
+	char name[64];
+	int x, y, k;
+
+	/* hard edges: the boundary is on the pixel borders */
+	for (y = 0; y < H; y++)
+	for (x = 0; x < W; x++) {
+		mask[y * W + x] = x < 40 ? 1.0f : 0.0f;
+		ref[y * W + x] = x + 0.5f - 40;
+	}
+	check("hard vertical edge", 0.001f);
+
+	/* sub-pixel offset carried through the transform */
+	for (y = 0; y < H; y++)
+	for (x = 0; x < W; x++) {
+		mask[y * W + x] = x < 40 ? 1.0f : (x == 40 ? 0.25f : 0.0f);
+		ref[y * W + x] = x + 0.5f - 40.25f;
+	}
+	check("aa vertical edge", 0.001f);
+
+	for (y = 0; y < H; y++)
+	for (x = 0; x < W; x++) {
+		float dx = M_MAX(M_MAX(30 - (x + 0.5f), (x + 0.5f) - 60), 0);
+		float dy = M_MAX(M_MAX(30 - (y + 0.5f), (y + 0.5f) - 60), 0);
+		float din = M_MIN(M_MIN((x + 0.5f) - 30, 60 - (x + 0.5f)), M_MIN((y + 0.5f) - 30, 60 - (y + 0.5f)));
+		int inside = x >= 30 && x < 60 && y >= 30 && y < 60;
+		mask[y * W + x] = inside ? 1.0f : 0.0f;
+		ref[y * W + x] = inside ? -din : sqrtf(dx * dx + dy * dy);
+	}
+	check("hard square", 0.001f);
+
+	/* anti-aliased straight edges */
+	for (k = 0; k < 24; k++) {
+		float angle = k * 3.14159265f / 24 + 0.05f;
+		float nx = cosf(angle);
+		float ny = sinf(angle);
+		float c = nx * (W * 0.5f + 0.3f) + ny * (H * 0.5f - 0.2f);
+
+		for (y = 0; y < H; y++)
+		for (x = 0; x < W; x++) {
+			mask[y * W + x] = cover_half_plane(x, y, nx, ny, c);
+			ref[y * W + x] = nx * (x + 0.5f) + ny * (y + 0.5f) - c;
+		}
+		sprintf(name, "aa edge %5.1f deg", angle * 180 / 3.14159265f);
+		check(name, 0.06f);
+	}
+
+	/* anti-aliased disc */
+	for (y = 0; y < H; y++)
+	for (x = 0; x < W; x++) {
+		float dx = x + 0.5f - 48.3f;
+		float dy = y + 0.5f - 47.6f;
+		mask[y * W + x] = cover_disc(x, y, 48.3f, 47.6f, 21.4f);
+		ref[y * W + x] = sqrtf(dx * dx + dy * dy) - 21.4f;
+	}
+	check("aa disc", 0.06f);
+
+	/* jump flooding */
+	srand(0);
+	for (k = 1; k <= 64; k *= 2)
+		check_jfa(k);
+
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
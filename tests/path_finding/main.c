@@ -0,0 +1,641 @@
+/*======================================================================
+    Maratis Tiny C Library
+    version 1.0
+------------------------------------------------------------------------
+    Copyright (c) 2016 Anael Seghezzi <www.maratis3d.com>
+
+    This software is provided 'as-is', without any express or implied
+    warranty. In no event will the authors be held liable for any damages
+    arising from the use of this software.
+
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would
+    be appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not
+    be misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution.
+
+========================================================================*/
+
+/* path finding checks on small fixed maps (A*, JPS, floodfill, Dijkstra, flow field, LPA*, HPA*)
+   then benchmark (floodfill, A*, JPS, HPA*) on open and maze maps */
+
+#define M_PF_IMPLEMENTATION
+#include <m_path_finding.h>
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#define MAP_W 1024
+#define MAP_H 1024
+#define QUERY_COUNT 64
+
+static unsigned int *map = NULL;
+static unsigned int *score = NULL;
+static struct m_pf_point *stack = NULL;
+static struct m_pf_point *path = NULL;
+static int queries[QUERY_COUNT][4];
+
+
+static void gen_open(void)
+{
+	int i;
+	for (i = 0; i < MAP_W * MAP_H; i++)
+		map[i] = (rand() % 50) == 0 ? UINT_MAX : 0;
+}
+
+/* recursive backtracker on odd cells */
+static void gen_maze(void)
+{
+	int *cells = (int *)stack;
+	int count = 0;
+	int i;
+
+	for (i = 0; i < MAP_W * MAP_H; i++)
+		map[i] = UINT_MAX;
+
+	map[MAP_W + 1] = 0;
+	cells[count++] = MAP_W + 1;
+
+	while (count > 0) {
+
+		int c = cells[count - 1];
+		int x = c % MAP_W;
+		int y = c / MAP_W;
+		int next[4], n = 0;
+
+		if (x > 2 && map[c - 2] == UINT_MAX) next[n++] = -1;
+		if (x < MAP_W - 3 && map[c + 2] == UINT_MAX) next[n++] = 1;
+		if (y > 2 && map[c - 2 * MAP_W] == UINT_MAX) next[n++] = -MAP_W;
+		if (y < MAP_H - 3 && map[c + 2 * MAP_W] == UINT_MAX) next[n++] = MAP_W;
+
+		if (n == 0) {
+			count--;
+			continue;
+		}
+
+		n = next[rand() % n];
+		map[c + n] = 0;
+		map[c + 2 * n] = 0;
+		cells[count++] = c + 2 * n;
+	}
+}
+
+static void gen_queries(void)
+{
+	int i;
+	for (i = 0; i < QUERY_COUNT; i++) {
+		do {
+			queries[i][0] = rand() % MAP_W;
+			queries[i][1] = rand() % MAP_H;
+			queries[i][2] = rand() % MAP_W;
+			queries[i][3] = rand() % MAP_H;
+		} while (map[queries[i][1] * MAP_W + queries[i][0]] == UINT_MAX ||
+		         map[queries[i][3] * MAP_W + queries[i][2]] == UINT_MAX);
+	}
+}
+
+/* wall-clock time in seconds (clock() sums the time of all threads) */
+static double get_time(void)
+{
+#ifdef _OPENMP
+	return omp_get_wtime();
+#else
+	return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+static double elapsed_ms(double t)
+{
+	return (get_time() - t) * 1000.0 / QUERY_COUNT;
+}
+
+/* correctness checks on small fixed maps against a brute-force reference */
+
+#define SMALL_W 48
+#define SMALL_H 40
+#define SMALL_SIZE (SMALL_W * SMALL_H)
+
+static unsigned char small_cost[SMALL_SIZE];
+static unsigned int small_map[SMALL_SIZE];
+static unsigned int small_ref[SMALL_SIZE];
+static unsigned int small_dist[SMALL_SIZE];
+static float small_costf[SMALL_SIZE];
+static float small_distf[SMALL_SIZE];
+static unsigned char small_dir[SMALL_SIZE];
+
+
+/* walls (cost 0) in about 1 cell out of wall_rate, other costs in [1, max_cost] */
+static void gen_small(int wall_rate, int max_cost)
+{
+	int i;
+	for (i = 0; i < SMALL_SIZE; i++) {
+		small_cost[i] = (rand() % wall_rate) == 0 ? 0 : (unsigned char)(1 + rand() % max_cost);
+		small_map[i] = small_cost[i] == 0 ? UINT_MAX : 0;
+	}
+}
+
+static int is_wall(int x, int y)
+{
+	return x < 0 || y < 0 || x >= SMALL_W || y >= SMALL_H || small_cost[SMALL_W * y + x] == 0;
+}
+
+/* cost of the step from (x0, y0) to (x1, y1), 0 if it is not a valid step */
+static unsigned int step_cost(int x0, int y0, int x1, int y1, int connectivity)
+{
+	int dx = x1 - x0;
+	int dy = y1 - y0;
+
+	if (dx < -1 || dx > 1 || dy < -1 || dy > 1 || (dx == 0 && dy == 0) || is_wall(x1, y1))
+		return 0;
+	if (dx == 0 || dy == 0)
+		return M_PF_COST_STRAIGHT;
+	if (connectivity == 4 || is_wall(x1, y0) || is_wall(x0, y1))
+		return 0;
+	return M_PF_COST_DIAGONAL;
+}
+
+/* Bellman-Ford relaxation until stable (sweeping forward then backward),
+   same units as m_pf_dijkstra_ubyte */
+static void ref_dist(unsigned int *dist, int x, int y, int connectivity)
+{
+	int changed = 1;
+	int sweep = 0;
+	int i;
+
+	for (i = 0; i < SMALL_SIZE; i++)
+		dist[i] = UINT_MAX;
+	if (!is_wall(x, y))
+		dist[SMALL_W * y + x] = 0;
+
+	while (changed) {
+		changed = 0;
+		for (i = 0; i < SMALL_SIZE; i++) {
+			int c = sweep % 2 ? SMALL_SIZE - 1 - i : i;
+			int cx = c % SMALL_W;
+			int cy = c / SMALL_W;
+			int xn, yn;
+			if (dist[c] == UINT_MAX)
+				continue;
+			for (yn = cy - 1; yn <= cy + 1; yn++)
+			for (xn = cx - 1; xn <= cx + 1; xn++) {
+				unsigned int step = step_cost(cx, cy, xn, yn, connectivity);
+				unsigned int d = dist[c] + small_cost[c] * step;
+				if (step > 0 && d < dist[SMALL_W * yn + xn]) {
+					dist[SMALL_W * yn + xn] = d;
+					changed = 1;
+				}
+			}
+		}
+		sweep++;
+	}
+}
+
+/* path from (x0, y0) excluded to (x1, y1) included, return its cost (entering a cell costs its weight),
+   or UINT_MAX if it is not a valid path */
+static unsigned int path_cost(const struct m_pf_point *points, int count, int x0, int y0, int x1, int y1, int connectivity)
+{
+	unsigned int total = 0;
+	int i;
+
+	if (count == 0 || points[count - 1].x != x1 || points[count - 1].y != y1)
+		return UINT_MAX;
+
+	for (i = 0; i < count; i++) {
+		int x = points[i].x;
+		int y = points[i].y;
+		unsigned int step = step_cost(x0, y0, x, y, connectivity);
+		if (step == 0)
+			return UINT_MAX;
+		total += small_cost[SMALL_W * y + x] * step;
+		x0 = x;
+		y0 = y;
+	}
+
+	return total;
+}
+
+static int report(const char *name, int errors)
+{
+	printf("%-28s %s (%d errors)\n", name, errors ? "FAILED" : "ok", errors);
+	return errors > 0;
+}
+
+/* A* (both heuristics) and JPS path costs equal to the reference distances */
+static int check_astar(void)
+{
+	struct m_pf_context ctx;
+	int errors_astar = 0, errors_jps = 0;
+	int g, i;
+
+	m_pf_context_create(&ctx, SMALL_W, SMALL_H);
+
+	srand(1);
+	gen_small(4, 1);
+
+	for (g = 0; g < 8; g++) {
+
+		int x1 = rand() % SMALL_W;
+		int y1 = rand() % SMALL_H;
+		int c;
+
+		for (c = 4; c <= 8; c += 4) {
+
+			ref_dist(small_ref, x1, y1, c);
+
+			for (i = 0; i < SMALL_SIZE; i++) {
+
+				int x0 = i % SMALL_W;
+				int y0 = i / SMALL_W;
+				unsigned int expected = small_ref[i];
+				int count;
+
+				if (is_wall(x0, y0) || is_wall(x1, y1) || (x0 == x1 && y0 == y1))
+					continue;
+
+				count = m_pf_astar(&ctx, path, SMALL_SIZE, small_map, x0, y0, x1, y1, c == 8 ? M_PF_OCTILE : M_PF_MANHATTAN);
+				if (count == 0 ? expected != UINT_MAX : path_cost(path, count, x0, y0, x1, y1, c) != expected)
+					errors_astar++;
+
+				if (c == 8) {
+					count = m_pf_jps(&ctx, path, SMALL_SIZE, small_map, x0, y0, x1, y1);
+					if (count == 0 ? expected != UINT_MAX : path_cost(path, count, x0, y0, x1, y1, c) != expected)
+						errors_jps++;
+				}
+			}
+		}
+	}
+
+	m_pf_context_destroy(&ctx);
+	return report("A* cost", errors_astar) | report("JPS cost", errors_jps);
+}
+
+/* floodfill distances, backtrace reaches the destination */
+static int check_floodfill(void)
+{
+	int errors = 0;
+	int g, i;
+
+	srand(2);
+	gen_small(4, 1);
+
+	for (g = 0; g < 8; g++) {
+
+		int x1 = rand() % SMALL_W;
+		int y1 = rand() % SMALL_H;
+
+		if (is_wall(x1, y1))
+			continue;
+
+		ref_dist(small_ref, x1, y1, 4);
+		memcpy(small_dist, small_map, sizeof(small_dist));
+		m_pf_floodfill(small_dist, SMALL_W, SMALL_H, x1, y1, (struct m_pf_point *)stack);
+
+		for (i = 0; i < SMALL_SIZE; i++) {
+
+			unsigned int expected;
+			int count, k;
+
+			if (small_cost[i] == 0) {
+				errors += small_dist[i] != UINT_MAX;
+				continue;
+			}
+			if (small_ref[i] == UINT_MAX) {
+				errors += small_dist[i] != 0;
+				continue;
+			}
+
+			/* number of steps (the destination itself is visited twice) */
+			expected = small_ref[i] / M_PF_COST_STRAIGHT;
+			if (expected == 0)
+				continue;
+			if (small_dist[i] != expected) {
+				errors++;
+				continue;
+			}
+
+			/* each step goes down, the last one to a cell next to the destination */
+			count = m_pf_backtrace(path, small_dist, SMALL_W, SMALL_H, i % SMALL_W, i / SMALL_W);
+			if (count == 0 || count > (int)expected || small_dist[path[count - 1].y * SMALL_W + path[count - 1].x] != 1)
+				errors++;
+			for (k = 1; k < count; k++) {
+				if (small_dist[path[k].y * SMALL_W + path[k].x] >= small_dist[path[k - 1].y * SMALL_W + path[k - 1].x])
+					errors++;
+			}
+		}
+	}
+
+	return report("floodfill distance", errors);
+}
+
+/* weighted Dijkstra (ubyte and float) equal to the reference */
+static int check_dijkstra(void)
+{
+	int errors_ubyte = 0, errors_float = 0;
+	int g, i;
+
+	srand(3);
+	gen_small(5, 255);
+	for (i = 0; i < SMALL_SIZE; i++)
+		small_costf[i] = small_cost[i] == 0 ? -1.0f : (float)small_cost[i];
+
+	for (g = 0; g < 8; g++) {
+
+		int x = rand() % SMALL_W;
+		int y = rand() % SMALL_H;
+		int c = g % 2 ? 8 : 4;
+
+		ref_dist(small_ref, x, y, c);
+		m_pf_dijkstra_ubyte(small_dist, small_cost, SMALL_W, SMALL_H, x, y, c);
+		m_pf_dijkstra_float(small_distf, small_costf, SMALL_W, SMALL_H, x, y, c);
+
+		for (i = 0; i < SMALL_SIZE; i++) {
+			float expected = small_ref[i] == UINT_MAX ? M_PF_FLOAT_MAX : (float)small_ref[i];
+			float error = small_distf[i] > expected ? small_distf[i] - expected : expected - small_distf[i];
+			errors_ubyte += small_dist[i] != small_ref[i];
+			errors_float += error > expected * 1e-5f;
+		}
+	}
+
+	return report("dijkstra ubyte", errors_ubyte) | report("dijkstra float", errors_float);
+}
+
+/* flow field: distance to the nearest seed, following dir always goes down to a seed */
+static int check_flow_field(void)
+{
+	struct m_pf_point seeds[3];
+	int errors = 0;
+	int s, i;
+
+	srand(4);
+	gen_small(4, 1);
+
+	for (s = 0; s < 3; s++) {
+		do {
+			seeds[s].x = (unsigned short)(rand() % SMALL_W);
+			seeds[s].y = (unsigned short)(rand() % SMALL_H);
+		} while (is_wall(seeds[s].x, seeds[s].y));
+	}
+
+	/* nearest seed in 4-connectivity (seeds = 1) */
+	for (i = 0; i < SMALL_SIZE; i++)
+		small_dist[i] = UINT_MAX;
+	for (s = 0; s < 3; s++) {
+		ref_dist(small_ref, seeds[s].x, seeds[s].y, 4);
+		for (i = 0; i < SMALL_SIZE; i++)
+			small_dist[i] = small_ref[i] < small_dist[i] ? small_ref[i] : small_dist[i];
+	}
+
+	memcpy(small_ref, small_map, sizeof(small_ref));
+	m_pf_flow_field(small_dir, small_ref, SMALL_W, SMALL_H, seeds, 3, (struct m_pf_point *)stack);
+
+	for (i = 0; i < SMALL_SIZE; i++) {
+
+		int x = i % SMALL_W;
+		int y = i / SMALL_W;
+		unsigned int v = small_ref[i];
+		int steps = 0;
+
+		if (small_cost[i] == 0 || small_dist[i] == UINT_MAX) {
+			errors += v != (small_cost[i] == 0 ? UINT_MAX : 0) || small_dir[i] != M_PF_FLOW_NONE;
+			continue;
+		}
+		if (v != small_dist[i] / M_PF_COST_STRAIGHT + 1) {
+			errors++;
+			continue;
+		}
+
+		while (v > 1 && steps < SMALL_SIZE) {
+			unsigned char d = small_dir[SMALL_W * y + x];
+			int xn = x + M_PF_FLOW_DX(d);
+			int yn = y + M_PF_FLOW_DY(d);
+			if (d == M_PF_FLOW_NONE || step_cost(x, y, xn, yn, 8) == 0 || small_ref[SMALL_W * yn + xn] >= v)
+				break;
+			x = xn;
+			y = yn;
+			v = small_ref[SMALL_W * y + x];
+			steps++;
+		}
+
+		errors += v != 1 || small_dir[SMALL_W * y + x] != M_PF_FLOW_NONE;
+	}
+
+	return report("flow field", errors);
+}
+
+/* LPA* after edits equal to a fresh search, its paths cost the distance */
+static int check_lpa(void)
+{
+	int errors_field = 0, errors_path = 0;
+	int c;
+
+	for (c = 4; c <= 8; c += 4) {
+
+		struct m_pf_lpa lpa;
+		int x1, y1, r, i;
+
+		srand(5 + c);
+		gen_small(5, 20);
+
+		do {
+			x1 = rand() % SMALL_W;
+			y1 = rand() % SMALL_H;
+		} while (is_wall(x1, y1));
+
+		m_pf_lpa_create(&lpa, small_cost, SMALL_W, SMALL_H, x1, y1, c);
+
+		for (r = 0; r < 16; r++) {
+
+			/* add or remove walls and change costs */
+			if (r > 0) {
+				int e;
+				for (e = 0; e < 8; e++) {
+					int x = rand() % SMALL_W;
+					int y = rand() % SMALL_H;
+					if (x == x1 && y == y1)
+						continue;
+					small_cost[SMALL_W * y + x] = (rand() % 3) == 0 ? 0 : (unsigned char)(1 + rand() % 20);
+					m_pf_lpa_notify(&lpa, x, y);
+				}
+				m_pf_lpa_compute(&lpa);
+			}
+
+			m_pf_dijkstra_ubyte(small_dist, small_cost, SMALL_W, SMALL_H, x1, y1, c);
+			ref_dist(small_ref, x1, y1, c);
+
+			for (i = 0; i < SMALL_SIZE; i++) {
+
+				int count;
+
+				if (lpa.g[i] != small_ref[i] || small_dist[i] != small_ref[i]) {
+					errors_field++;
+					continue;
+				}
+				if (small_ref[i] == 0 || small_ref[i] == UINT_MAX || (i % 7) != 0)
+					continue;
+
+				/* the descent enters the cells the reference search left */
+				count = m_pf_lpa_path(&lpa, path, SMALL_SIZE, i % SMALL_W, i / SMALL_W);
+				if (path_cost(path, count, i % SMALL_W, i / SMALL_W, x1, y1, c) != small_ref[i])
+					errors_path++;
+			}
+		}
+
+		m_pf_lpa_destroy(&lpa);
+	}
+
+	return report("LPA* after edits", errors_field) | report("LPA* path cost", errors_path);
+}
+
+/* HPA* paths valid, found when a path exists, never shorter than the optimum,
+   also after a map edit */
+static int check_hpa(void)
+{
+	struct m_pf_hpa hpa;
+	int errors = 0;
+	int x1 = 0, y1 = 0;
+	int r, q;
+
+	srand(6);
+	gen_small(4, 1);
+	for (q = 0; q < SMALL_SIZE; q++)
+		small_cost[q] = small_cost[q] != 0;
+
+	m_pf_hpa_create(&hpa, small_map, SMALL_W, SMALL_H, 8);
+
+	for (r = 0; r < 2; r++) {
+
+		if (r > 0) {
+			/* wall a 10x6 rect crossing cluster borders */
+			int x, y;
+			for (y = 5; y < 11; y++)
+			for (x = 12; x < 22; x++) {
+				small_map[SMALL_W * y + x] = UINT_MAX;
+				small_cost[SMALL_W * y + x] = 0;
+			}
+			m_pf_hpa_update(&hpa, 12, 5, 10, 6);
+		}
+
+		for (q = 0; q < 256; q++) {
+
+			int x0 = rand() % SMALL_W;
+			int y0 = rand() % SMALL_H;
+			unsigned int cost;
+			int count;
+
+			/* 8 goals, 32 queries each */
+			if ((q % 32) == 0) {
+				do {
+					x1 = rand() % SMALL_W;
+					y1 = rand() % SMALL_H;
+				} while (is_wall(x1, y1));
+				ref_dist(small_ref, x1, y1, 8);
+			}
+
+			if (is_wall(x0, y0) || (x0 == x1 && y0 == y1))
+				continue;
+
+			count = m_pf_hpa_find(&hpa, path, SMALL_SIZE, x0, y0, x1, y1);
+			if (count == 0) {
+				errors += small_ref[SMALL_W * y0 + x0] != UINT_MAX;
+				continue;
+			}
+
+			cost = path_cost(path, count, x0, y0, x1, y1, 8);
+			errors += cost == UINT_MAX || cost < small_ref[SMALL_W * y0 + x0];
+		}
+	}
+
+	m_pf_hpa_destroy(&hpa);
+	return report("HPA* paths", errors);
+}
+
+static void bench(const char *name, struct m_pf_context *ctx)
+{
+	double t;
+	struct m_pf_hpa hpa;
+	int i, len_ff = 0, len_astar = 0, len_jps = 0, len_hpa = 0;
+
+	gen_queries();
+
+	/* floodfill + backtrace */
+	t = get_time();
+	for (i = 0; i < QUERY_COUNT; i++) {
+		memcpy(score, map, MAP_W * MAP_H * sizeof(unsigned int));
+		m_pf_floodfill(score, MAP_W, MAP_H, queries[i][2], queries[i][3], stack);
+		len_ff += m_pf_backtrace(path, score, MAP_W, MAP_H, queries[i][0], queries[i][1]);
+	}
+	printf("%s floodfill: %8.3f ms/query (%d steps)\n", name, elapsed_ms(t), len_ff);
+
+	/* A* */
+	t = get_time();
+	for (i = 0; i < QUERY_COUNT; i++)
+		len_astar += m_pf_astar(ctx, path, MAP_W * MAP_H, map, queries[i][0], queries[i][1], queries[i][2], queries[i][3], M_PF_OCTILE);
+	printf("%s A*:        %8.3f ms/query (%d steps)\n", name, elapsed_ms(t), len_astar);
+
+	/* JPS */
+	t = get_time();
+	for (i = 0; i < QUERY_COUNT; i++)
+		len_jps += m_pf_jps(ctx, path, MAP_W * MAP_H, map, queries[i][0], queries[i][1], queries[i][2], queries[i][3]);
+	printf("%s JPS:       %8.3f ms/query (%d steps)\n", name, elapsed_ms(t), len_jps);
+
+	/* HPA* */
+	t = get_time();
+	m_pf_hpa_create(&hpa, map, MAP_W, MAP_H, 16);
+	printf("%s HPA* build: %7.3f ms\n", name, elapsed_ms(t) * QUERY_COUNT);
+
+	t = get_time();
+	for (i = 0; i < QUERY_COUNT; i++)
+		len_hpa += m_pf_hpa_find(&hpa, path, MAP_W * MAP_H, queries[i][0], queries[i][1], queries[i][2], queries[i][3]);
+	printf("%s HPA*:      %8.3f ms/query (%d steps)\n", name, elapsed_ms(t), len_hpa);
+
+	m_pf_hpa_destroy(&hpa);
+}
+
+int main(void)
+{
+	struct m_pf_context ctx;
+	int failed = 0;
+
+	map = (unsigned int *)malloc(MAP_W * MAP_H * sizeof(unsigned int));
+	score = (unsigned int *)malloc(MAP_W * MAP_H * sizeof(unsigned int));
+	stack = (struct m_pf_point *)malloc((MAP_W * MAP_H + 1) * sizeof(struct m_pf_point));
+	path = (struct m_pf_point *)malloc(MAP_W * MAP_H * sizeof(struct m_pf_point));
+	m_pf_context_create(&ctx, MAP_W, MAP_H);
+
+	failed |= check_astar();
+	failed |= check_floodfill();
+	failed |= check_dijkstra();
+	failed |= check_flow_field();
+	failed |= check_lpa();
+	failed |= check_hpa();
+
+	srand(0);
+
+	gen_open();
+	bench("open", &ctx);
+
+	gen_maze();
+	bench("maze", &ctx);
+
+	m_pf_context_destroy(&ctx);
+	free(path);
+	free(stack);
+	free(score);
+	free(map);
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
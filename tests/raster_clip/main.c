@@ -0,0 +1,232 @@
+/*======================================================================
+    Maratis Tiny C Library
+    version 1.0
+------------------------------------------------------------------------
+    Copyright (c) 2016 Anael Seghezzi <www.maratis3d.com>
+
+    This software is provided 'as-is', without any express or implied
+    warranty. In no event will the authors be held liable for any damages
+    arising from the use of this software.
+
+    Permission is granted to anyone to use this software for any purpose,
+    including commercial applications, and to alter it and redistribute it
+    freely, subject to the following restrictions:
+
+    1. The origin of this software must not be misrepresented; you must not
+    claim that you wrote the original software. If you use this software
+    in a product, an acknowledgment in the product documentation would
+    be appreciated but is not required.
+
+    2. Altered source versions must be plainly marked as such, and must not
+    be misrepresented as being the original software.
+
+    3. This notice may not be removed or altered from any source
+    distribution.
+
+========================================================================*/
+
+/* clipped mesh test: rasterizing without attributes writes the same depth
+   as with attributes and leaves dest untouched,
+   clipped coverage test: polygons partly outside the image stay inside acc
+   and cover the area of their visible part,
+   depth smaller than dest: the depth buffer is indexed with its own width */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define M_MATH_IMPLEMENTATION
+#define M_RASTER_IMPLEMENTATION
+#include <m_math.h>
+#include <m_raster.h>
+
+#define W 64
+#define H 64
+#define COMP 4
+#define GUARD 16
+#define POLYGON_COUNT 2000
+
+static float image[W * H * COMP];
+static float depth_ref[W * H];
+static float acc_guard[GUARD + W * H + GUARD];
+static float cover[W * H];
+
+
+/* clip a convex polygon to the half-plane s * p[axis] <= s * v (Sutherland-Hodgman) */
+static int clip_polygon(float *dest, const float *src, int count, int axis, float v, float s)
+{
+	int i, n = 0;
+	for (i = 0; i < count; i++) {
+		const float *a = src + i * 2;
+		const float *b = src + ((i + 1) % count) * 2;
+		float da = s * (a[axis] - v);
+		float db = s * (b[axis] - v);
+		if (da <= 0) {
+			dest[n * 2] = a[0]; dest[n * 2 + 1] = a[1]; n++;
+		}
+		if ((da < 0 && db > 0) || (da > 0 && db < 0)) {
+			float t = da / (da - db);
+			dest[n * 2] = a[0] + (b[0] - a[0]) * t;
+			dest[n * 2 + 1] = a[1] + (b[1] - a[1]) * t;
+			n++;
+		}
+	}
+	return n;
+}
+
+/* area of a convex polygon inside the image (pixel i covers [i - 0.5, i + 0.5]) */
+static float visible_area(const float *points, int count)
+{
+	float p0[64], p1[64];
+	float area = 0;
+	int i;
+
+	memcpy(p0, points, count * 2 * sizeof(float));
+	count = clip_polygon(p1, p0, count, 0, -0.5f, -1);
+	count = clip_polygon(p0, p1, count, 0, W - 0.5f, 1);
+	count = clip_polygon(p1, p0, count, 1, -0.5f, -1);
+	count = clip_polygon(p0, p1, count, 1, H - 0.5f, 1);
+
+	for (i = 0; i < count; i++) {
+		const float *a = p0 + i * 2;
+		const float *b = p0 + ((i + 1) % count) * 2;
+		area += a[0] * b[1] - b[0] * a[1];
+	}
+	return fabsf(area) * 0.5f;
+}
+
+static int check_coverage_clip(void)
+{
+	float *acc = acc_guard + GUARD;
+	float one = 1;
+	float max_error = 0;
+	int outside = 0;
+	int p, i;
+
+	srand(0);
+	for (p = 0; p < POLYGON_COUNT; p++) {
+
+		/* convex polygon in [-2w, 3w] x [-2h, 3h] */
+		float points[16];
+		float cx = ((float)rand() / RAND_MAX) * 5 * W - 2 * W;
+		float cy = ((float)rand() / RAND_MAX) * 5 * H - 2 * H;
+		float r = 1 + ((float)rand() / RAND_MAX) * 2 * W;
+		float angle = 0;
+		float sum = 0;
+		int count = 3 + rand() % 6;
+
+		for (i = 0; i < count; i++) {
+			angle += (0.1f + (float)rand() / RAND_MAX) * (6.2831853f / count) * 0.9f;
+			points[i * 2] = cx + r * cosf(angle);
+			points[i * 2 + 1] = cy + r * sinf(angle);
+		}
+
+		m_raster_coverage_polygons(acc, W, H, points, &count, 1);
+
+		for (i = 0; i < GUARD; i++)
+			outside += (acc_guard[i] != 0) + (acc[W * H + i] != 0);
+
+		memset(cover, 0, sizeof(cover));
+		m_raster_coverage_resolve(cover, W, H, 1, acc, &one);
+		for (i = 0; i < W * H; i++)
+			sum += cover[i];
+
+		max_error = M_MAX(max_error, fabsf(sum - visible_area(points, count)));
+	}
+
+	printf("coverage partly outside:   %d writes outside, area error %f %s\n",
+		outside, max_error, (outside == 0 && max_error < 0.05f) ? "ok" : "FAILED");
+	return outside > 0 || max_error >= 0.05f;
+}
+
+static int check_mesh_clip(void)
+{
+	/* a quad crossing the near plane (z < -w on the far side) and a triangle inside the screen */
+	float vertices[] = {
+		-2.0f, -1.0f,  0.5f, 1.0f,
+		 2.0f, -1.0f,  0.5f, 1.0f,
+		 2.0f,  1.0f, -3.0f, 1.0f,
+		-2.0f,  1.0f, -3.0f, 1.0f,
+		-0.5f, -0.5f,  0.0f, 2.0f,
+		 0.5f, -0.5f,  0.0f, 2.0f,
+		 0.0f,  0.5f,  0.0f, 2.0f
+	};
+	float attributes[7 * COMP];
+	int indices[] = {0, 2, 1, 0, 3, 2, 4, 6, 5};
+	struct m_raster_depth depth;
+	int i, written = 0, failed = 0;
+
+	for (i = 0; i < 7 * COMP; i++)
+		attributes[i] = (float)(i + 1);
+
+	m_raster_depth_create(&depth, W, H);
+
+	/* reference: with attributes */
+	m_raster_depth_clear(&depth);
+	m_raster_mesh_clip_attn(image, COMP, &depth, W, H, vertices, attributes, 7, indices, 3);
+	memcpy(depth_ref, depth.data, W * H * sizeof(float));
+	for (i = 0; i < W * H; i++)
+		written += depth_ref[i] > 0.0f;
+
+	/* without attributes */
+	for (i = 0; i < W * H * COMP; i++)
+		image[i] = -1.0f;
+	m_raster_depth_clear(&depth);
+	m_raster_mesh_clip_attn(image, COMP, &depth, W, H, vertices, NULL, 7, indices, 3);
+
+	for (i = 0; i < W * H; i++) {
+		if (depth.data[i] != depth_ref[i])
+			failed = 1;
+	}
+	printf("depth without attributes:  %d pixels %s\n", written, (written > 0 && !failed) ? "ok" : "FAILED");
+	failed |= written == 0;
+
+	for (i = 0; i < W * H * COMP; i++) {
+		if (image[i] != -1.0f)
+			break;
+	}
+	printf("dest without attributes:   %s\n", i == W * H * COMP ? "ok" : "FAILED");
+	failed |= i < W * H * COMP;
+
+	m_raster_depth_destroy(&depth);
+	return failed;
+}
+
+static int check_depth_size(void)
+{
+	float v0[4] = {-10, -10, 0, 1}, v1[4] = {100, -10, 0, 0.5f}, v2[4] = {-10, 100, 0, 0.25f};
+	float a[COMP] = {1, 1, 1, 1};
+	float depth_ref[32 * 32];
+	struct m_raster_depth depth;
+	int i, failed = 0;
+
+	m_raster_depth_create(&depth, 32, 32);
+
+	/* dest as wide as the depth buffer */
+	m_raster_depth_clear(&depth);
+	m_raster_triangle_attn(image, COMP, &depth, 32, 32, v0, v2, v1, a, a, a);
+	memcpy(depth_ref, depth.data, sizeof(depth_ref));
+
+	/* wider dest */
+	m_raster_depth_clear(&depth);
+	m_raster_triangle_attn(image, COMP, &depth, W, H, v0, v2, v1, a, a, a);
+
+	for (i = 0; i < 32 * 32; i++) {
+		if (depth.data[i] != depth_ref[i] || depth_ref[i] <= 0)
+			failed = 1;
+	}
+	printf("depth smaller than dest:   %s\n", failed ? "FAILED" : "ok");
+
+	m_raster_depth_destroy(&depth);
+	return failed;
+}
+
+int main(void)
+{
+	int failed = 0;
+	failed |= check_mesh_clip();
+	failed |= check_depth_size();
+	failed |= check_coverage_clip();
+	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}